@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Сравнение результатов бенчмарков (run_bench.py) с сохранённой базой.
+
+Случаи сопоставляются по имени. Регрессия — медиана времени счёта выросла больше чем на
+--threshold (по умолчанию 10 %) и абсолютно больше --min-delta секунд (шум коротких замеров).
+Код возврата 1, если найдена хотя бы одна регрессия.
+
+Пример: python3 bench/compare_bench.py bench/baseline.json bench/results.json --threshold=0.05
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(path):
+    with open(path) as handle:
+        report = json.load(handle)
+    return {entry["name"]: entry for entry in report["results"]}, report.get("meta", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Сравнение результатов бенчмарков с базой")
+    parser.add_argument("baseline", help="JSON базовых результатов")
+    parser.add_argument("current", help="JSON текущих результатов")
+    parser.add_argument("--threshold", type=float, default=0.10, help="допустимый относительный рост медианы")
+    parser.add_argument("--min-delta", type=float, default=0.002, help="минимальный значимый рост медианы, с")
+    args = parser.parse_args()
+
+    baseline, baseline_meta = load_results(args.baseline)
+    current, current_meta = load_results(args.current)
+    print("baseline: %s (%s), current: %s (%s)" % (
+        baseline_meta.get("git_revision"), baseline_meta.get("timestamp"),
+        current_meta.get("git_revision"), current_meta.get("timestamp")))
+    print("%-55s %12s %12s %9s  %s" % ("case", "base, s", "current, s", "change", "status"))
+
+    regressions = 0
+    for name, entry in current.items():
+        reference = baseline.get(name)
+        now = entry["compute_time"]["median"]
+        if reference is None:
+            print("%-55s %12s %12.6f %9s  new" % (name, "-", now, "-"))
+            continue
+
+        before = reference["compute_time"]["median"]
+        change = (now - before) / before if before > 0 else 0.0
+        if change > args.threshold and now - before > args.min_delta:
+            status = "REGRESSION"
+            regressions += 1
+        elif change < -args.threshold and before - now > args.min_delta:
+            status = "improved"
+        else:
+            status = "ok"
+        print("%-55s %12.6f %12.6f %+8.1f%%  %s" % (name, before, now, change * 100.0, status))
+
+    for name in baseline:
+        if name not in current:
+            print("%-55s %12.6f %12s %9s  missing" % (name, baseline[name]["compute_time"]["median"], "-", "-"))
+
+    print("\nРегрессий: %d" % regressions)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
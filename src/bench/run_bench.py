@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+"""
+Набор бенчмарков для dijkstra_serial и dijkstra_mpi.
+
+Перебирает размеры графа, плотности, движки и число процессов. Для каждого случая
+делает прогревочные запуски, затем повторные замеры и сохраняет результаты в JSON:
+медиана и p95 времени счёта (строка "Compute time", замер внутри программ по
+steady_clock / MPI_Wtime) и полного времени процесса (time.perf_counter),
+пропускная способность в рёбрах в секунду и пиковый RSS.
+
+Пример: python3 bench/run_bench.py --sizes=1000,2000 --np=1,2,4 --output=bench/results.json
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import re
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+SRC_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SERIAL_BIN = os.path.join(SRC_DIR, "dijkstra_serial", "dijkstra_serial.out")
+MPI_BIN = os.path.join(SRC_DIR, "dijkstra_mpi", "dijkstra_mpi.out")
+
+# Движки: имя -> дополнительные аргументы программы
+SERIAL_ENGINES = {
+    "dense": ["--engine=dense"],
+    "csr": ["--engine=csr"],
+    "delta": ["--engine=delta"],
+}
+MPI_ENGINES = {
+    "bcast": ["--comm=bcast"],
+    "minimal": ["--comm=minimal"],
+    "delta": ["--engine=delta"],
+    "2d": ["--partition=2d"],
+}
+
+COMPUTE_RE = re.compile(r"Compute time:\s*([0-9.eE+-]+)")
+EDGES_RE = re.compile(r"edges:\s*(\d+)")
+
+
+def parse_list(text, cast):
+    return [cast(item) for item in text.split(",") if item.strip()]
+
+
+def percentile(values, q):
+    """Перцентиль методом ближайшего ранга."""
+    ordered = sorted(values)
+    rank = max(1, math.ceil(q / 100.0 * len(ordered)))
+    return ordered[rank - 1]
+
+
+def summarize(values):
+    return {
+        "median": statistics.median(values),
+        "p95": percentile(values, 95),
+        "min": min(values),
+        "max": max(values),
+    }
+
+
+def run_once(command, timeout):
+    """
+    Один запуск: стенное время, время счёта из вывода программы и пиковый RSS.
+
+    RSS берётся из os.wait4 — ru_maxrss ребёнка и дождавшихся его потомков
+    (для mpiexec это максимум по процессам MPI на узле), в килобайтах.
+    """
+    with tempfile.TemporaryFile(mode="w+") as output:
+        start = time.perf_counter()
+        process = subprocess.Popen(command, stdout=output, stderr=subprocess.STDOUT)
+        deadline = start + timeout
+        while True:
+            pid, status, usage = os.wait4(process.pid, os.WNOHANG)
+            if pid != 0:
+                break
+            if time.perf_counter() > deadline:
+                process.kill()
+                pid, status, usage = os.wait4(process.pid, 0)
+                raise RuntimeError("превышен тайм-аут %d с: %s" % (timeout, " ".join(command)))
+            time.sleep(0.005)
+        wall = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+
+        output.seek(0)
+        text = output.read()
+
+    if process.returncode != 0:
+        raise RuntimeError("код возврата %d: %s\n%s" % (process.returncode, " ".join(command), text))
+    match = COMPUTE_RE.search(text)
+    if not match:
+        raise RuntimeError("в выводе нет строки 'Compute time': %s\n%s" % (" ".join(command), text))
+    return {"wall": wall, "compute": float(match.group(1)), "maxrss_kb": usage.ru_maxrss, "output": text}
+
+
+def count_edges(n, density, seed, timeout):
+    """Точное число дуг сгенерированного графа — по выводу CSR-движка последовательной версии."""
+    result = run_once([SERIAL_BIN, str(n), "--engine=csr", "--density=%g" % density, "--seed=%d" % seed], timeout)
+    match = EDGES_RE.search(result["output"])
+    return int(match.group(1)) if match else None
+
+
+def is_square(value):
+    root = int(math.isqrt(value))
+    return root * root == value
+
+
+def build_cases(args):
+    cases = []
+    for n in args.sizes:
+        for density in args.densities:
+            graph_args = ["--density=%g" % density, "--seed=%d" % args.seed]
+            for engine in args.serial_engines:
+                cases.append({
+                    "program": "serial", "engine": engine, "n": n, "density": density, "np": 1, "threads": 1,
+                    "command": [SERIAL_BIN, str(n)] + SERIAL_ENGINES[engine] + graph_args
+                               + (["--threads=%d" % args.serial_threads] if engine == "delta" else []),
+                })
+            for engine in args.mpi_engines:
+                for np in args.np:
+                    if np > n or (engine == "2d" and not is_square(np)):
+                        continue
+                    threads = args.threads if engine != "delta" else 1
+                    cases.append({
+                        "program": "mpi", "engine": engine, "n": n, "density": density, "np": np, "threads": threads,
+                        "command": shlex.split(args.mpiexec) + ["-np", str(np), MPI_BIN, str(n)] + MPI_ENGINES[engine]
+                                   + graph_args + ["--threads=%d" % threads],
+                    })
+    for case in cases:
+        case["name"] = "%s/%s n=%d density=%g np=%d threads=%d" % (
+            case["program"], case["engine"], case["n"], case["density"], case["np"], case["threads"])
+    return cases
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], cwd=SRC_DIR, text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Бенчмарки последовательной и MPI-версий Дейкстры")
+    parser.add_argument("--sizes", default="1000,2000,4000", help="размеры графа через запятую")
+    parser.add_argument("--densities", default="1.0,0.1", help="плотности графа через запятую")
+    parser.add_argument("--serial-engines", default="dense,csr,delta", help="движки dijkstra_serial (dense,csr,delta)")
+    parser.add_argument("--mpi-engines", default="bcast,minimal,delta,2d", help="движки dijkstra_mpi (bcast,minimal,delta,2d)")
+    parser.add_argument("--np", default="1,2,4", help="числа процессов MPI через запятую")
+    parser.add_argument("--threads", type=int, default=1, help="потоков на процесс MPI (--threads)")
+    parser.add_argument("--serial-threads", type=int, default=os.cpu_count() or 1, help="потоков serial delta-stepping")
+    parser.add_argument("--seed", type=int, default=1, help="зерно генератора графа")
+    parser.add_argument("--warmup", type=int, default=1, help="прогревочных запусков на случай")
+    parser.add_argument("--repeat", type=int, default=5, help="замеряемых запусков на случай")
+    parser.add_argument("--timeout", type=int, default=600, help="тайм-аут одного запуска, с")
+    parser.add_argument("--mpiexec", default="mpiexec", help="команда запуска MPI (например, 'mpiexec --oversubscribe')")
+    parser.add_argument("--output", default=os.path.join(SRC_DIR, "bench", "results.json"), help="файл результатов JSON")
+    args = parser.parse_args()
+
+    args.sizes = parse_list(args.sizes, int)
+    args.densities = parse_list(args.densities, float)
+    args.serial_engines = parse_list(args.serial_engines, str)
+    args.mpi_engines = parse_list(args.mpi_engines, str)
+    args.np = parse_list(args.np, int)
+    for engine in args.serial_engines:
+        if engine not in SERIAL_ENGINES:
+            parser.error("неизвестный последовательный движок: " + engine)
+    for engine in args.mpi_engines:
+        if engine not in MPI_ENGINES:
+            parser.error("неизвестный MPI-движок: " + engine)
+    if args.repeat < 1:
+        parser.error("--repeat должен быть >= 1")
+    for binary in ([SERIAL_BIN] + ([MPI_BIN] if args.mpi_engines else [])):
+        if not os.path.exists(binary):
+            parser.error("не найден %s — сначала выполните make" % binary)
+
+    edges = {}
+    for n in args.sizes:
+        for density in args.densities:
+            edges[(n, density)] = count_edges(n, density, args.seed, args.timeout)
+
+    results = []
+    cases = build_cases(args)
+    for index, case in enumerate(cases, 1):
+        for _ in range(args.warmup):
+            run_once(case["command"], args.timeout)
+        runs = [run_once(case["command"], args.timeout) for _ in range(args.repeat)]
+
+        compute = [run["compute"] for run in runs]
+        wall = [run["wall"] for run in runs]
+        num_edges = edges[(case["n"], case["density"])]
+        compute_stats = summarize(compute)
+        entry = {key: case[key] for key in ("name", "program", "engine", "n", "density", "np", "threads")}
+        entry.update({
+            "command": " ".join(case["command"]),
+            "edges": num_edges,
+            "compute_time": compute_stats,
+            "wall_time": summarize(wall),
+            # Каждая вершина извлекается один раз и релаксирует все свои дуги
+            "edges_per_sec": num_edges / compute_stats["median"] if num_edges and compute_stats["median"] > 0 else None,
+            "peak_rss_kb": max(run["maxrss_kb"] for run in runs),
+            "runs": {"compute": compute, "wall": wall},
+        })
+        results.append(entry)
+        print("[%d/%d] %-55s median %.6f s  p95 %.6f s  rss %d KB" % (
+            index, len(cases), case["name"], compute_stats["median"], compute_stats["p95"], entry["peak_rss_kb"]), flush=True)
+
+    # Ускорение относительно последовательного плотного движка на том же графе
+    serial_dense = {(r["n"], r["density"]): r["compute_time"]["median"]
+                    for r in results if r["program"] == "serial" and r["engine"] == "dense"}
+    for entry in results:
+        reference = serial_dense.get((entry["n"], entry["density"]))
+        entry["speedup_vs_serial_dense"] = reference / entry["compute_time"]["median"] \
+            if reference and entry["compute_time"]["median"] > 0 else None
+
+    report = {
+        "meta": {
+            "timestamp": datetime.datetime.now().isoformat(timespec="seconds"),
+            "host": platform.node(),
+            "cpu_count": os.cpu_count(),
+            "git_revision": git_revision(),
+            "seed": args.seed,
+            "warmup": args.warmup,
+            "repeat": args.repeat,
+            "timing": "compute_time — из вывода программ (steady_clock / MPI_Wtime), wall_time — time.perf_counter",
+        },
+        "results": results,
+    }
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w") as handle:
+        json.dump(report, handle, indent=2, ensure_ascii=False)
+    print("Результаты записаны в %s" % args.output)
+
+    print("\n%-55s %12s %10s %14s" % ("case", "median, s", "speedup", "edges/s"))
+    for entry in results:
+        speedup = entry["speedup_vs_serial_dense"]
+        rate = entry["edges_per_sec"]
+        print("%-55s %12.6f %10s %14s" % (entry["name"], entry["compute_time"]["median"],
+                                          "%.2fx" % speedup if speedup else "-", "%.3e" % rate if rate else "-"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
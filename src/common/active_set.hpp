@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Сжатый список непосещённых вершин плотного Дейкстры.
+ *
+ * ids[k] — номер вершины (локальный для отрезка, который обрабатывает владелец списка),
+ * dist[k] — её текущее расстояние; оба массива непрерывны, поэтому SIMD-ядра
+ * (argmin_active, relax_active) проходят только по ещё не посещённым вершинам.
+ * Посещённая вершина удаляется перестановкой последнего элемента на её место, так что
+ * список сокращается на один элемент за итерацию, а порядок вершин в нём произволен.
+ * @tparam D Тип расстояния (int или std::int64_t).
+ */
+template <typename D>
+class ActiveSet {
+public:
+    // Все вершины [0, count) непосещены; начальные расстояния берутся из dist
+    void assign(const D *dist, int count) {
+        ids_.resize(count);
+        dist_.assign(dist, dist + count);
+        for (int v = 0; v < count; ++v) ids_[v] = v;
+        size_ = count;
+    }
+
+    int size() const { return size_; }
+    int vertex(int pos) const { return ids_[pos]; }
+    const int *ids() const { return ids_.data(); }
+    D *dist() { return dist_.data(); }
+    const D *dist() const { return dist_.data(); }
+
+    // Вершина на позиции pos посещена: её окончательное расстояние записывается в out_dist
+    void settle(int pos, D *out_dist) {
+        out_dist[ids_[pos]] = dist_[pos];
+        --size_;
+        ids_[pos] = ids_[size_];
+        dist_[pos] = dist_[size_];
+    }
+
+    // Текущие расстояния оставшихся вершин — в out_dist (после выхода из основного цикла)
+    void flush(D *out_dist) const {
+        for (int k = 0; k < size_; ++k) out_dist[ids_[k]] = dist_[k];
+    }
+
+private:
+    std::vector<int> ids_;
+    std::vector<D> dist_;
+    int size_ = 0;
+};
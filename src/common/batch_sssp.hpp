@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "simd_kernels.hpp"
+#include "weight_types.hpp"
+
+/**
+ * @brief Разбор списка источников: "all" или номера и диапазоны через запятую ("0,5,7", "0-63,100").
+ * @param spec Строка из параметра --sources.
+ * @param countVertices Количество вершин (для "all" и проверки диапазона).
+ * @param sources [out] Список источников.
+ * @param error [out] Описание ошибки.
+ * @return false, если элемент списка не число или диапазон a-b (a <= b), либо номер вне [0, countVertices).
+ */
+inline bool parseSourceList(const std::string &spec, int countVertices, std::vector<int> &sources, std::string &error) {
+    sources.clear();
+    if (spec == "all") {
+        for (int v = 0; v < countVertices; ++v) sources.push_back(v);
+        return true;
+    }
+
+    // Номер вершины должен занимать весь текст: stoi сам по себе принимает числовой префикс ("5abc")
+    auto parse_vertex = [countVertices](const std::string &text, int &v) {
+        if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+        try {
+            std::size_t pos = 0;
+            v = std::stoi(text, &pos);
+            return pos == text.size() && v < countVertices;
+        } catch (const std::exception &) {
+            return false;
+        }
+    };
+
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::size_t dash = item.find('-');
+        int first = 0, last = 0;
+        bool ok = dash == std::string::npos
+                      ? parse_vertex(item, first) && parse_vertex(item, last)
+                      : parse_vertex(item.substr(0, dash), first) && parse_vertex(item.substr(dash + 1), last) && first <= last;
+        if (!ok) {
+            error = "некорректный элемент \"" + item + "\" (ожидается номер или диапазон a-b в [0, " +
+                    std::to_string(countVertices) + "))";
+            return false;
+        }
+        for (int v = first; v <= last; ++v) sources.push_back(v);
+    }
+    if (sources.empty()) {
+        error = "пустой список источников";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Ширина корзины пакетного режима: 4 * max_weight / средняя степень (не меньше 1).
+ *
+ * Как autoDelta в delta-stepping, но в 4 раза шире: проход по строке стоит K дорожек,
+ * поэтому выгоднее меньше корзин и проходов ценой части повторных релаксаций.
+ */
+template <typename W>
+inline int batchBucketWidth(const W *graph, int n) {
+    int max_weight = 1;
+    std::uint64_t edges = 0;
+    const std::size_t cells = static_cast<std::size_t>(n) * n;
+    for (std::size_t i = 0; i < cells; ++i) {
+        if (graph[i] == WeightTraits<W>::kNoEdge) continue;
+        ++edges;
+        if (decodeWeight(graph[i]) > max_weight) max_weight = decodeWeight(graph[i]);
+    }
+
+    std::uint64_t avg_degree = n > 0 ? edges / n : 1;
+    if (avg_degree < 1) avg_degree = 1;
+    std::uint64_t delta = 4ULL * max_weight / avg_degree;
+    return delta < 1 ? 1 : delta > static_cast<std::uint64_t>(INF) ? INF : static_cast<int>(delta);
+}
+
+// Вершин в плитке блока: расстояния и предки плитки остаются в кэше, пока по ней проходят все строки прохода
+constexpr int kBatchTileVertices = 256;
+
+/**
+ * @brief Пакетный поиск кратчайших путей сразу от K источников (min-plus ядро).
+ *
+ * Расстояния хранятся блоком по вершинам: K расстояний вершины v лежат подряд, и строка u,
+ * загруженная из матрицы, релаксирует все K векторов одним K-wide SIMD-ядром
+ * (relaxRowBlock*): dist[v][k] = min(dist[v][k], dist[u][k] + w(u, v)).
+ * Дорожка (u, k) релаксируется, только если её расстояние уменьшилось с прошлой релаксации.
+ * Порядок задают корзины ширины delta, как в delta-stepping: проходы по строкам с такими
+ * дорожками в корзине [min, min + delta) повторяются, пока корзина не опустеет. Расстояния
+ * меньше начала корзины окончательны, и вершины, окончательные для всех источников, из
+ * релаксации исключаются. Столбцы обходятся плитками по kBatchTileVertices вершин.
+ *
+ * Строка читается один раз на проход для всех источников, поэтому строк загружается в разы
+ * меньше, чем K * n у отдельных запусков плотного движка. Часть дорожек релаксируется раньше,
+ * чем их расстояние станет окончательным, так что выигрыш по счёту меньше, чем по памяти.
+ *
+ * @tparam W Тип веса матрицы (uint8_t, uint16_t или int).
+ * @param graph Плоская матрица смежности n*n (row-major), WeightTraits<W>::kNoEdge — нет ребра.
+ * @param n Количество вершин.
+ * @param sources Источники (K штук).
+ * @param num_sources Число источников K.
+ * @param dist [out] Блок расстояний K*n: dist[k * n + v].
+ * @param pred [out] Блок предшественников K*n.
+ * @param relax_block K-wide ядро релаксации (selectRowBlockKernel).
+ * @param delta Ширина корзины (batchBucketWidth).
+ * @return Число загруженных строк матрицы.
+ */
+template <typename W>
+inline std::uint64_t batchShortestPaths(const W *graph, int n, const int *sources, int num_sources, int *dist, int *pred,
+                                        RowBlockKernel<W> relax_block, int delta) {
+    const int lanes = (num_sources + kBlockLaneAlign - 1) / kBlockLaneAlign * kBlockLaneAlign;
+    const std::size_t block = static_cast<std::size_t>(n) * lanes;
+
+    // relaxed — расстояние, с которым дорожка релаксировалась последний раз (INF — ещё ни разу);
+    // дорожки выравнивания за num_sources остаются INF и никогда не релаксируются
+    std::vector<int> block_dist(block, INF), block_pred(block, -1), relaxed(block, INF);
+    for (int k = 0; k < num_sources; ++k) {
+        block_dist[static_cast<std::size_t>(sources[k]) * lanes + k] = 0;
+    }
+
+    std::vector<int> columns;        // вершины, расстояния которых ещё могут уменьшиться
+    std::vector<int> rows;           // строки текущего прохода
+    std::vector<int> base(block);    // их расстояния на начало прохода (INF — дорожка не участвует)
+    std::vector<std::pair<int, int>> row_lanes;  // [first, last) участвующих дорожек строки, кратно kBlockLaneAlign
+    std::uint64_t row_loads = 0;
+    while (true) {
+        int bucket_min = INF;
+        for (std::size_t i = 0; i < block; ++i) {
+            if (block_dist[i] < relaxed[i] && block_dist[i] < bucket_min) bucket_min = block_dist[i];
+        }
+        if (bucket_min == INF) break;
+        const int bucket_end = bucket_min > INF - delta ? INF : bucket_min + delta;
+
+        // Расстояния меньше bucket_min окончательны: вершина, у которой окончательны все дорожки,
+        // больше не релаксируется (как посещённые вершины плотного движка)
+        columns.clear();
+        for (int v = 0; v < n; ++v) {
+            const int *dist_v = block_dist.data() + static_cast<std::size_t>(v) * lanes;
+            bool open = false;
+            for (int k = 0; k < num_sources; ++k) open |= dist_v[k] >= bucket_min;
+            if (open) columns.push_back(v);
+        }
+
+        while (true) {
+            rows.clear();
+            row_lanes.clear();
+            for (int u = 0; u < n; ++u) {
+                const int *dist_u = block_dist.data() + static_cast<std::size_t>(u) * lanes;
+                int *relaxed_u = relaxed.data() + static_cast<std::size_t>(u) * lanes;
+                int *base_u = base.data() + rows.size() * lanes;
+                int first_lane = lanes, last_lane = 0;
+                for (int k = 0; k < lanes; ++k) {
+                    bool take = dist_u[k] < relaxed_u[k] && dist_u[k] < bucket_end;
+                    base_u[k] = take ? dist_u[k] : INF;
+                    if (!take) continue;
+                    relaxed_u[k] = dist_u[k];
+                    first_lane = std::min(first_lane, k);
+                    last_lane = k + 1;
+                }
+                if (last_lane == 0) continue;
+                rows.push_back(u);
+                // Ядро проходит только векторы с участвующими дорожками
+                row_lanes.emplace_back(first_lane / kBlockLaneAlign * kBlockLaneAlign,
+                                       (last_lane + kBlockLaneAlign - 1) / kBlockLaneAlign * kBlockLaneAlign);
+            }
+            if (rows.empty()) break;
+            row_loads += rows.size();
+
+            const int num_columns = static_cast<int>(columns.size());
+            for (int first = 0; first < num_columns; first += kBatchTileVertices) {
+                const int m = std::min(kBatchTileVertices, num_columns - first);
+                for (std::size_t r = 0; r < rows.size(); ++r) {
+                    const W *row = graph + static_cast<std::size_t>(rows[r]) * n;
+                    const int lo = row_lanes[r].first;
+                    relax_block(row, columns.data() + first, m, base.data() + r * lanes + lo, rows[r], block_dist.data() + lo,
+                                block_pred.data() + lo, row_lanes[r].second - lo, lanes);
+                }
+            }
+        }
+    }
+
+    for (int k = 0; k < num_sources; ++k) {
+        for (int v = 0; v < n; ++v) {
+            dist[static_cast<std::size_t>(k) * n + v] = block_dist[static_cast<std::size_t>(v) * lanes + k];
+            pred[static_cast<std::size_t>(k) * n + v] = block_pred[static_cast<std::size_t>(v) * lanes + k];
+        }
+    }
+    return row_loads;
+}
+
+/**
+ * @brief Запись блока расстояний K*n в бинарный файл.
+ *
+ * Формат (int32, порядок байт машины): K, n, sources[K], dist[K * n] (INF = INT32_MAX).
+ * @return false при ошибке ввода-вывода.
+ */
+inline bool writeDistanceBlock(const std::string &path, const std::vector<int> &sources, int n, const int *dist) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    std::int32_t header[2] = {static_cast<std::int32_t>(sources.size()), n};
+    std::size_t block = sources.size() * static_cast<std::size_t>(n);
+    bool ok = std::fwrite(header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(sources.data(), sizeof(int), sources.size(), file) == sources.size() &&
+              std::fwrite(dist, sizeof(int), block, file) == block;
+
+    return std::fclose(file) == 0 && ok;
+}
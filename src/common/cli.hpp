@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Разбор аргумента командной строки вида --name=value.
+ * @param arg Аргумент командной строки.
+ * @param name Имя ключа вместе с префиксом, например "--engine".
+ * @param value [out] Значение после '='.
+ * @return true, если аргумент соответствует ключу.
+ */
+inline bool parseOption(const char *arg, const char *name, std::string &value) {
+    std::size_t name_len = std::strlen(name);
+    if (std::strncmp(arg, name, name_len) != 0 || arg[name_len] != '=') return false;
+
+    value = arg + name_len + 1;
+    return true;
+}
+
+/**
+ * @brief Проверка флага без значения, например --selftest.
+ */
+inline bool parseFlag(const char *arg, const char *name) {
+    return std::strcmp(arg, name) == 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "weight_types.hpp"
+
+constexpr int INF = std::numeric_limits<int>::max();
+
+/**
+ * @brief Ребро ориентированного графа (для неориентированного задаётся парой рёбер).
+ */
+struct Edge {
+    int from;
+    int to;
+    int weight;
+};
+
+/**
+ * @brief Разреженный граф в формате CSR (compressed sparse row).
+ *
+ * Соседи вершины u лежат в col_indices/weights на отрезке
+ * [row_offsets[u], row_offsets[u + 1]).
+ */
+struct CsrGraph {
+    int num_vertices = 0;
+    std::vector<int> row_offsets; // размер num_vertices + 1
+    std::vector<int> col_indices; // размер num_edges
+    std::vector<int> weights;     // размер num_edges
+
+    int numEdges() const { return static_cast<int>(col_indices.size()); }
+    int maxWeight() const {
+        int max_w = 0;
+        for (int w : weights) {
+            if (w > max_w) max_w = w;
+        }
+        return max_w;
+    }
+};
+
+/**
+ * @brief Построение CSR-графа из списка рёбер (сортировка подсчётом по вершине-источнику).
+ * @param countVertices Количество вершин.
+ * @param edges Список ориентированных рёбер.
+ */
+inline CsrGraph buildCsrFromEdges(int countVertices, const std::vector<Edge> &edges) {
+    CsrGraph graph;
+    graph.num_vertices = countVertices;
+    graph.row_offsets.assign(countVertices + 1, 0);
+    graph.col_indices.resize(edges.size());
+    graph.weights.resize(edges.size());
+
+    for (const Edge &e : edges) {
+        graph.row_offsets[e.from + 1]++;
+    }
+    for (int u = 0; u < countVertices; ++u) {
+        graph.row_offsets[u + 1] += graph.row_offsets[u];
+    }
+
+    std::vector<int> cursor(graph.row_offsets.begin(), graph.row_offsets.end() - 1);
+    for (const Edge &e : edges) {
+        int pos = cursor[e.from]++;
+        graph.col_indices[pos] = e.to;
+        graph.weights[pos] = e.weight;
+    }
+
+    return graph;
+}
+
+/**
+ * @brief Построение CSR-графа из блока строк плоской матрицы смежности (row-major).
+ *
+ * Коды отсутствия ребра (INF для int) пропускаются, петли (диагональ) отбрасываются.
+ * Номера столбцов остаются глобальными, строки нумеруются локально с нуля —
+ * так процесс MPI хранит исходящие рёбра своих вершин.
+ * @param rows Указатель на первую строку блока.
+ * @param num_rows Число строк в блоке.
+ * @param countVertices Общее число вершин (длина строки).
+ * @param first_row Глобальный номер первой строки блока.
+ */
+template <typename W>
+inline CsrGraph buildCsrFromDenseRows(const W *rows, int num_rows, int countVertices, int first_row) {
+    const std::size_t n = countVertices;
+    CsrGraph graph;
+    graph.num_vertices = num_rows;
+    graph.row_offsets.assign(num_rows + 1, 0);
+
+    for (int r = 0; r < num_rows; ++r) {
+        int u = first_row + r;
+        const W *row = rows + r * n;
+        for (int v = 0; v < countVertices; ++v) {
+            if (u != v && row[v] != WeightTraits<W>::kNoEdge) {
+                graph.col_indices.push_back(v);
+                graph.weights.push_back(static_cast<int>(row[v]));
+            }
+        }
+        graph.row_offsets[r + 1] = static_cast<int>(graph.col_indices.size());
+    }
+
+    return graph;
+}
+
+/**
+ * @brief Транспонирование CSR-графа: дуга u -> v становится v -> u (сортировка подсчётом).
+ *
+ * Нужно обратному поиску двунаправленного Дейкстры на ориентированном графе.
+ */
+inline CsrGraph transposeCsr(const CsrGraph &graph) {
+    CsrGraph reversed;
+    reversed.num_vertices = graph.num_vertices;
+    reversed.row_offsets.assign(graph.num_vertices + 1, 0);
+    reversed.col_indices.resize(graph.col_indices.size());
+    reversed.weights.resize(graph.weights.size());
+
+    for (int v : graph.col_indices) {
+        reversed.row_offsets[v + 1]++;
+    }
+    for (int v = 0; v < graph.num_vertices; ++v) {
+        reversed.row_offsets[v + 1] += reversed.row_offsets[v];
+    }
+
+    std::vector<int> cursor(reversed.row_offsets.begin(), reversed.row_offsets.end() - 1);
+    for (int u = 0; u < graph.num_vertices; ++u) {
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            int pos = cursor[graph.col_indices[e]]++;
+            reversed.col_indices[pos] = u;
+            reversed.weights[pos] = graph.weights[e];
+        }
+    }
+
+    return reversed;
+}
@@ -0,0 +1,474 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph.hpp"
+#include "weight_types.hpp"
+
+/**
+ * Бинарный формат графа (порядок байт машины, все секции выровнены на 8 байт):
+ *
+ *   GraphFileHeader (64 байта)
+ *   dense: weights[n * n]                        — матрица смежности row-major
+ *   csr:   row_offsets[n + 1] (uint64), col_indices[m] (uint32), weights[m]
+ *
+ * Ширина веса — 1, 2 или 4 байта. Отсутствие ребра в плотной матрице кодируется
+ * максимальным значением типа: 0xFF, 0xFFFF или INT32_MAX (= INF).
+ */
+constexpr char kGraphFileMagic[8] = {'S', 'S', 'S', 'P', 'G', 'R', 'F', '1'};
+constexpr std::uint32_t kGraphFileVersion = 1;
+
+enum GraphLayout : std::uint32_t { kLayoutDense = 0, kLayoutCsr = 1 };
+enum GraphFlags : std::uint32_t { kFlagSymmetric = 1 };
+
+struct GraphFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t layout;        // GraphLayout
+    std::uint32_t weight_bytes;  // 1, 2 или 4
+    std::uint32_t flags;         // GraphFlags
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;     // для dense — число присутствующих рёбер (без диагонали)
+    std::uint64_t payload_offset;
+    std::uint8_t reserved[16];
+};
+static_assert(sizeof(GraphFileHeader) == 64, "GraphFileHeader must be 64 bytes");
+
+inline std::uint64_t alignTo8(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t(7); }
+
+/**
+ * @brief Код отсутствия ребра для ширины веса.
+ */
+inline std::uint32_t noEdgeCode(std::uint32_t weight_bytes) {
+    if (weight_bytes == 1) return 0xFFu;
+    if (weight_bytes == 2) return 0xFFFFu;
+    return static_cast<std::uint32_t>(INF);
+}
+
+/**
+ * @brief Минимальная ширина веса, вмещающая max_weight (с учётом кода отсутствия ребра).
+ */
+inline std::uint32_t weightBytesFor(int max_weight) {
+    if (max_weight < 0xFF) return 1;
+    if (max_weight < 0xFFFF) return 2;
+    return 4;
+}
+
+/**
+ * @brief Проверка заголовка: сигнатура, версия, раскладка, ширина веса и размеры графа.
+ */
+inline bool validateGraphHeader(const GraphFileHeader &header, std::string &error) {
+    if (std::memcmp(header.magic, kGraphFileMagic, sizeof(kGraphFileMagic)) != 0) {
+        error = "неверная сигнатура файла графа";
+        return false;
+    }
+    if (header.version != kGraphFileVersion) {
+        error = "неподдерживаемая версия формата";
+        return false;
+    }
+    if (header.layout != kLayoutDense && header.layout != kLayoutCsr) {
+        error = "неизвестная раскладка графа";
+        return false;
+    }
+    if (header.weight_bytes != 1 && header.weight_bytes != 2 && header.weight_bytes != 4) {
+        error = "неподдерживаемая ширина веса";
+        return false;
+    }
+    if (header.num_vertices > static_cast<std::uint64_t>(INF)) {
+        error = "слишком много вершин";
+        return false;
+    }
+    // Смещения CsrGraph::row_offsets 32-битные: больший файл усёк бы их при загрузке
+    if (header.layout == kLayoutCsr && header.num_edges > static_cast<std::uint64_t>(INF)) {
+        error = "CSR-файл содержит " + std::to_string(header.num_edges) + " рёбер, поддерживается не более " +
+                std::to_string(INF);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Смещения секций CSR относительно начала файла.
+ */
+struct CsrSections {
+    std::uint64_t offsets;
+    std::uint64_t columns;
+    std::uint64_t weights;
+    std::uint64_t end;
+};
+
+inline CsrSections csrSections(const GraphFileHeader &header) {
+    CsrSections s;
+    s.offsets = header.payload_offset;
+    s.columns = alignTo8(s.offsets + (header.num_vertices + 1) * sizeof(std::uint64_t));
+    s.weights = alignTo8(s.columns + header.num_edges * sizeof(std::uint32_t));
+    s.end = s.weights + header.num_edges * header.weight_bytes;
+    return s;
+}
+
+/**
+ * @brief Проверка смещений строк [first_row, first_row + num_rows) CSR-файла: offsets[0..num_rows].
+ *
+ * Смещения не убывают и не выходят за num_edges; первая строка файла начинается с 0,
+ * последняя заканчивается на num_edges. Проверка по отрезкам строк (MPI-чтение блоками)
+ * покрывает весь файл, если отрезки покрывают все строки.
+ */
+inline bool validateCsrOffsets(const GraphFileHeader &header, std::uint64_t first_row, const std::uint64_t *offsets,
+                               std::uint64_t num_rows, std::string &error) {
+    if (first_row == 0 && offsets[0] != 0) {
+        error = "CSR: offsets[0] = " + std::to_string(offsets[0]) + ", ожидается 0";
+        return false;
+    }
+    for (std::uint64_t r = 0; r < num_rows; ++r) {
+        if (offsets[r + 1] < offsets[r]) {
+            error = "CSR: смещения строк убывают в строке " + std::to_string(first_row + r);
+            return false;
+        }
+    }
+    if (offsets[num_rows] > header.num_edges ||
+        (first_row + num_rows == header.num_vertices && offsets[num_rows] != header.num_edges)) {
+        error = "CSR: offsets[" + std::to_string(first_row + num_rows) + "] = " + std::to_string(offsets[num_rows]) +
+                " не согласовано с числом рёбер " + std::to_string(header.num_edges);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Проверка номеров столбцов CSR-файла: каждый меньше числа вершин.
+ * @param first_edge Номер первого ребра отрезка columns[0..count) (для сообщения).
+ */
+inline bool validateCsrColumns(const GraphFileHeader &header, std::uint64_t first_edge, const std::uint32_t *columns,
+                               std::uint64_t count, std::string &error) {
+    for (std::uint64_t e = 0; e < count; ++e) {
+        if (columns[e] >= header.num_vertices) {
+            error = "CSR: ребро " + std::to_string(first_edge + e) + " ведёт в вершину " + std::to_string(columns[e]) +
+                    " вне [0, " + std::to_string(header.num_vertices) + ")";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Преобразование count весов ширины weight_bytes в тип W с переносом кода отсутствия ребра.
+ *
+ * При совпадении ширины — простое копирование. Веса должны помещаться в W.
+ */
+template <typename W>
+inline void widenWeights(const void *src, std::size_t count, std::uint32_t weight_bytes, W *dst) {
+    if (weight_bytes == sizeof(W)) {
+        std::memcpy(dst, src, count * sizeof(W));
+        return;
+    }
+    dispatchWeightType(weight_bytes, [&](auto tag) {
+        using S = decltype(tag);
+        const S *p = static_cast<const S *>(src);
+        for (std::size_t i = 0; i < count; ++i) dst[i] = encodeWeight<W>(decodeWeight(p[i]));
+    });
+}
+
+/**
+ * @brief Запись весов типа W в ширину weight_bytes; отсутствие ребра кодируется кодом ширины.
+ */
+template <typename W>
+inline void narrowWeights(const W *src, std::size_t count, std::uint32_t weight_bytes, void *dst) {
+    if (weight_bytes == sizeof(W)) {
+        std::memcpy(dst, src, count * sizeof(W));
+        return;
+    }
+    dispatchWeightType(weight_bytes, [&](auto tag) {
+        using S = decltype(tag);
+        S *p = static_cast<S *>(dst);
+        for (std::size_t i = 0; i < count; ++i) p[i] = encodeWeight<S>(decodeWeight(src[i]));
+    });
+}
+
+/**
+ * @brief Плотная матрица n * n типа W по CSR-графу: из кратных дуг остаётся самая лёгкая,
+ * петли отбрасываются (диагональ — 0), как при загрузке блоков в MPI-версии (densifyCsrRows).
+ */
+template <typename W>
+inline void densifyCsrGraph(const CsrGraph &graph, W *flat) {
+    const std::size_t n = graph.num_vertices;
+    std::fill(flat, flat + n * n, WeightTraits<W>::kNoEdge);
+    for (std::size_t u = 0; u < n; ++u) {
+        flat[u * n + u] = 0;
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            const std::size_t v = graph.col_indices[e];
+            if (v == u) continue;
+            W w = encodeWeight<W>(graph.weights[e]);
+            if (w < flat[u * n + v]) flat[u * n + v] = w;
+        }
+    }
+}
+
+namespace graph_file_detail {
+
+// Несовпадения densifyCsrGraph<W> с эталоном (минимум по кратным дугам, без петель) на случайных графах
+template <typename W>
+inline int densifySelfTestFailures(std::mt19937 &rng, int &cases) {
+    int failures = 0;
+    for (int trial = 0; trial < 100; ++trial, ++cases) {
+        const int n = 1 + static_cast<int>(rng() % 40);
+        std::vector<Edge> edges;
+        std::map<std::pair<int, int>, int> lightest;
+        for (int k = 0; k < 4 * n; ++k) {
+            // Мало различных пар на много дуг: кратные дуги и петли встречаются часто
+            int u = static_cast<int>(rng() % n), v = rng() % 4 == 0 ? u : static_cast<int>(rng() % n);
+            int w = static_cast<int>(rng() % (WeightTraits<W>::kMaxWeight + 1));
+            edges.push_back({u, v, w});
+            if (u == v) continue;
+            auto it = lightest.emplace(std::make_pair(u, v), w).first;
+            it->second = std::min(it->second, w);
+        }
+        std::vector<W> flat(static_cast<std::size_t>(n) * n);
+        densifyCsrGraph(buildCsrFromEdges(n, edges), flat.data());
+        bool match = true;
+        for (int u = 0; u < n; ++u) {
+            for (int v = 0; v < n; ++v) {
+                auto it = lightest.find({u, v});
+                int expected = u == v ? 0 : it == lightest.end() ? INF : it->second;
+                match = match && decodeWeight(flat[static_cast<std::size_t>(u) * n + v]) == expected;
+            }
+        }
+        if (!match) ++failures;
+    }
+    return failures;
+}
+
+} // namespace graph_file_detail
+
+/**
+ * @brief Самопроверка перевода CSR-графа в плотную матрицу для всех ширин веса.
+ * @return true, если все матрицы совпали с эталоном.
+ */
+inline bool densifySelfTest() {
+    std::mt19937 rng(777);
+    int cases = 0;
+    int failures = graph_file_detail::densifySelfTestFailures<std::uint8_t>(rng, cases) +
+                   graph_file_detail::densifySelfTestFailures<std::uint16_t>(rng, cases) +
+                   graph_file_detail::densifySelfTestFailures<int>(rng, cases);
+    std::printf("CSR -> dense self-test: %s (%d cases, %d failures)\n", failures == 0 ? "OK" : "FAIL", cases, failures);
+    return failures == 0;
+}
+
+/**
+ * @brief Файл графа, отображённый в память через mmap (только чтение).
+ *
+ * Плотная матрица любой ширины веса используется напрямую, без копирования
+ * (код отсутствия ребра совпадает с WeightTraits): страницы подгружаются ядром по мере обращения.
+ */
+class MappedGraphFile {
+public:
+    MappedGraphFile() = default;
+    MappedGraphFile(const MappedGraphFile &) = delete;
+    MappedGraphFile &operator=(const MappedGraphFile &) = delete;
+    ~MappedGraphFile() { close(); }
+
+    bool open(const std::string &path, std::string &error) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "не удалось открыть " + path;
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(GraphFileHeader)) {
+            ::close(fd);
+            error = "файл слишком мал для заголовка графа";
+            return false;
+        }
+
+        size_ = static_cast<std::size_t>(st.st_size);
+        void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            size_ = 0;
+            error = "ошибка mmap для " + path;
+            return false;
+        }
+        data_ = static_cast<const std::uint8_t *>(addr);
+        std::memcpy(&header_, data_, sizeof(header_));
+
+        if (!validateGraphHeader(header_, error)) {
+            close();
+            return false;
+        }
+
+        std::uint64_t expected_end = header_.layout == kLayoutDense
+            ? header_.payload_offset + header_.num_vertices * header_.num_vertices * header_.weight_bytes
+            : csrSections(header_).end;
+        if (expected_end > size_) {
+            error = "файл графа обрезан";
+            close();
+            return false;
+        }
+
+        // Смещения и столбцы CSR проверяются один раз здесь: toCsr и copyDense им доверяют
+        if (!isDense()) {
+            CsrSections sections = csrSections(header_);
+            if (!validateCsrOffsets(header_, 0, reinterpret_cast<const std::uint64_t *>(data_ + sections.offsets), header_.num_vertices, error) ||
+                !validateCsrColumns(header_, 0, reinterpret_cast<const std::uint32_t *>(data_ + sections.columns), header_.num_edges, error)) {
+                close();
+                return false;
+            }
+        }
+
+        // Матрица читается последовательно построчно
+        ::madvise(const_cast<std::uint8_t *>(data_), size_, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void close() {
+        if (data_) ::munmap(const_cast<std::uint8_t *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const GraphFileHeader &header() const { return header_; }
+    int numVertices() const { return static_cast<int>(header_.num_vertices); }
+    bool isDense() const { return header_.layout == kLayoutDense; }
+    bool isSymmetric() const { return (header_.flags & kFlagSymmetric) != 0; }
+
+    /**
+     * @brief Указатель на плотную матрицу типа W прямо в отображённой памяти
+     * (nullptr, если файл не плотный или ширина веса другая).
+     */
+    template <typename W>
+    const W *dense() const {
+        if (!isDense() || header_.weight_bytes != sizeof(W)) return nullptr;
+        return reinterpret_cast<const W *>(data_ + header_.payload_offset);
+    }
+
+    /**
+     * @brief Копия графа плотной матрицей типа W в out[n * n] (для CSR-файла или другой ширины веса).
+     */
+    template <typename W>
+    void copyDense(W *flat) const {
+        const std::size_t n = header_.num_vertices;
+
+        if (isDense()) {
+            widenWeights(data_ + header_.payload_offset, n * n, header_.weight_bytes, flat);
+            return;
+        }
+
+        densifyCsrGraph(toCsr(), flat);
+    }
+
+    /**
+     * @brief CSR-представление графа (для плотного файла строится по матрице).
+     */
+    CsrGraph toCsr() const {
+        const std::size_t n = header_.num_vertices;
+        if (isDense()) {
+            return dispatchWeightType(header_.weight_bytes, [&](auto tag) {
+                using W = decltype(tag);
+                return buildCsrFromDenseRows(dense<W>(), static_cast<int>(n), static_cast<int>(n), 0);
+            });
+        }
+
+        CsrSections sections = csrSections(header_);
+        const std::uint64_t *offsets = reinterpret_cast<const std::uint64_t *>(data_ + sections.offsets);
+        const std::uint32_t *columns = reinterpret_cast<const std::uint32_t *>(data_ + sections.columns);
+
+        CsrGraph graph;
+        graph.num_vertices = static_cast<int>(n);
+        graph.row_offsets.resize(n + 1);
+        for (std::size_t u = 0; u <= n; ++u) graph.row_offsets[u] = static_cast<int>(offsets[u]);
+        graph.col_indices.assign(columns, columns + header_.num_edges);
+        graph.weights.resize(header_.num_edges);
+        widenWeights(data_ + sections.weights, header_.num_edges, header_.weight_bytes, graph.weights.data());
+        return graph;
+    }
+
+private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    GraphFileHeader header_{};
+};
+
+inline GraphFileHeader makeGraphHeader(GraphLayout layout, std::uint32_t weight_bytes, bool symmetric,
+                                       std::uint64_t num_vertices, std::uint64_t num_edges) {
+    GraphFileHeader header{};
+    std::memcpy(header.magic, kGraphFileMagic, sizeof(kGraphFileMagic));
+    header.version = kGraphFileVersion;
+    header.layout = layout;
+    header.weight_bytes = weight_bytes;
+    header.flags = symmetric ? kFlagSymmetric : 0;
+    header.num_vertices = num_vertices;
+    header.num_edges = num_edges;
+    header.payload_offset = sizeof(GraphFileHeader);
+    return header;
+}
+
+/**
+ * @brief Запись плотной матрицы n*n (row-major) типа W в бинарный формат с шириной веса weight_bytes.
+ * Пишется построчно.
+ */
+template <typename W>
+inline bool writeDenseGraphFile(const std::string &path, const W *flat, int countVertices, std::uint32_t weight_bytes, bool symmetric) {
+    const std::size_t n = countVertices;
+    std::uint64_t num_edges = 0;
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t v = 0; v < n; ++v) {
+            if (u != v && flat[u * n + v] != WeightTraits<W>::kNoEdge) ++num_edges;
+        }
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    GraphFileHeader header = makeGraphHeader(kLayoutDense, weight_bytes, symmetric, n, num_edges);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    std::vector<std::uint8_t> row(n * weight_bytes);
+    for (std::size_t u = 0; ok && u < n; ++u) {
+        narrowWeights(flat + u * n, n, weight_bytes, row.data());
+        ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * @brief Запись CSR-графа в бинарный формат.
+ */
+inline bool writeCsrGraphFile(const std::string &path, const CsrGraph &graph, std::uint32_t weight_bytes, bool symmetric) {
+    const std::size_t n = graph.num_vertices;
+    const std::size_t m = graph.numEdges();
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    GraphFileHeader header = makeGraphHeader(kLayoutCsr, weight_bytes, symmetric, n, m);
+    CsrSections sections = csrSections(header);
+    const std::uint8_t padding[8] = {0};
+
+    std::vector<std::uint64_t> offsets(graph.row_offsets.begin(), graph.row_offsets.end());
+    std::vector<std::uint32_t> columns(graph.col_indices.begin(), graph.col_indices.end());
+    std::vector<std::uint8_t> weights(m * weight_bytes);
+    narrowWeights(graph.weights.data(), m, weight_bytes, weights.data());
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(offsets.data(), sizeof(std::uint64_t), n + 1, file) == n + 1;
+    std::uint64_t pos = sections.offsets + (n + 1) * sizeof(std::uint64_t);
+    ok = ok && std::fwrite(padding, 1, sections.columns - pos, file) == sections.columns - pos;
+    ok = ok && std::fwrite(columns.data(), sizeof(std::uint32_t), m, file) == m;
+    pos = sections.columns + m * sizeof(std::uint32_t);
+    ok = ok && std::fwrite(padding, 1, sections.weights - pos, file) == sections.weights - pos;
+    ok = ok && std::fwrite(weights.data(), 1, weights.size(), file) == weights.size();
+
+    return std::fclose(file) == 0 && ok;
+}
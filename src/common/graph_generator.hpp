@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cli.hpp"
+#include "graph.hpp"
+#include "weight_types.hpp"
+
+/**
+ * @brief Параметры генератора случайного неориентированного графа.
+ */
+struct GeneratorParams {
+    std::uint64_t seed = 0;
+    double density = 1.0; // вероятность ребра между парой вершин, (0, 1]
+    int min_weight = 0;
+    int max_weight = 99;
+};
+
+/**
+ * @brief Перемешивающая функция SplitMix64.
+ */
+inline std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Вес существующего ребра (lo, hi), lo < hi — чистая функция от (seed, lo, hi).
+ */
+inline int generatedPairWeight(const GeneratorParams &params, int lo, int hi) {
+    std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(lo)) << 32) | static_cast<std::uint32_t>(hi);
+    std::uint64_t h = splitMix64(splitMix64(params.seed) ^ key);
+    std::uint64_t range = static_cast<std::uint64_t>(params.max_weight) - params.min_weight + 1;
+    return params.min_weight + static_cast<int>(((h >> 32) * range) >> 32);
+}
+
+/**
+ * @brief Ширина блока столбцов разреженного генератора: степень двойки не меньше 8 / density и 128.
+ *
+ * Соседи hi > lo вершины lo выбираются независимыми последовательностями по блокам столбцов
+ * [J * width, (J + 1) * width): в блоке в среднем не меньше 8 рёбер, поэтому стоимость начала
+ * последовательности не превышает стоимости самих рёбер, а поиск ребра внутри одного блока
+ * обходится без прохода по всей строке.
+ */
+inline std::int64_t generatorBlockWidth(const GeneratorParams &params) {
+    std::int64_t width = 128;
+    while (width * params.density < 8.0 && width < (std::int64_t(1) << 32)) width *= 2;
+    return width;
+}
+
+/**
+ * @brief Соседи hi вершины lo из блока столбцов J, попадающие в [from, to), по возрастанию.
+ *
+ * Рёбра пары (lo, hi > lo) — схема Бернулли с вероятностью density; номера соседей
+ * порождаются геометрическими пропусками floor(ln U / ln(1 - density)), а U берётся из
+ * счётчикового ГСЧ по ключу (seed, lo, J). Поэтому время пропорционально числу рёбер,
+ * а любой блок последовательности воспроизводится на любом процессе.
+ * @param visit Функция void(int hi).
+ */
+template <typename Visit>
+inline void forEachGeneratedNeighbor(const GeneratorParams &params, double log_q, std::int64_t width, int lo, std::int64_t J,
+                                     std::int64_t from, std::int64_t to, Visit &&visit) {
+    std::int64_t end = std::min(to, (J + 1) * width);
+    std::int64_t pos = std::max<std::int64_t>(lo + 1, J * width) - 1;
+    if (std::max(pos + 1, from) >= end) return;
+
+    std::uint64_t key = splitMix64(splitMix64(params.seed ^ 0x6A09E667F3BCC909ULL) ^
+                                   ((static_cast<std::uint64_t>(static_cast<std::uint32_t>(lo)) << 32) | static_cast<std::uint64_t>(J)));
+    for (std::uint64_t k = 0;; ++k) {
+        // U в (0, 1]: старшие 53 бита + 1
+        double u = (static_cast<double>(splitMix64(key + k) >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+        double gap = std::floor(std::log(u) / log_q);
+        if (gap >= static_cast<double>(end - pos)) return;
+        pos += 1 + static_cast<std::int64_t>(gap);
+        if (pos >= end) return;
+        if (pos >= from) visit(static_cast<int>(pos));
+    }
+}
+
+/**
+ * @brief Плотный блок [first_row, first_row + num_rows) x [first_col, first_col + num_cols):
+ * out[r * num_cols + c] = w(first_row + r, first_col + c).
+ *
+ * Веса записываются в тип W (отсутствие ребра — WeightTraits<W>::kNoEdge). Граф не зависит
+ * от разбиения на блоки: он одинаков (и симметричен) при любом числе процессов.
+ */
+template <typename W>
+inline void generateDenseBlock(const GeneratorParams &params, int first_row, int num_rows, int first_col, int num_cols, W *out) {
+    const int row_end = first_row + num_rows, col_end = first_col + num_cols;
+    auto cell = [&](int u, int v) -> W & { return out[static_cast<std::size_t>(u - first_row) * num_cols + (v - first_col)]; };
+
+    if (params.density >= 1.0) {
+        for (int u = first_row; u < row_end; ++u) {
+            for (int v = first_col; v < col_end; ++v) {
+                cell(u, v) = u == v ? W(0) : encodeWeight<W>(u < v ? generatedPairWeight(params, u, v) : generatedPairWeight(params, v, u));
+            }
+        }
+        return;
+    }
+
+    std::fill(out, out + static_cast<std::size_t>(num_rows) * num_cols, WeightTraits<W>::kNoEdge);
+    for (int u = std::max(first_row, first_col); u < std::min(row_end, col_end); ++u) cell(u, u) = W(0);
+
+    const double log_q = std::log1p(-params.density);
+    const std::int64_t width = generatorBlockWidth(params);
+
+    // Верхний треугольник блока: соседи v > u строк блока
+    for (int u = first_row; u < row_end; ++u) {
+        std::int64_t from = std::max(first_col, u + 1);
+        for (std::int64_t J = from / width; J * width < col_end; ++J) {
+            forEachGeneratedNeighbor(params, log_q, width, u, J, from, col_end,
+                                     [&](int v) { cell(u, v) = encodeWeight<W>(generatedPairWeight(params, u, v)); });
+        }
+    }
+    // Нижний треугольник: строки u > v, где v — столбец блока
+    for (int v = first_col; v < col_end; ++v) {
+        std::int64_t from = std::max(first_row, v + 1);
+        for (std::int64_t I = from / width; I * width < row_end; ++I) {
+            forEachGeneratedNeighbor(params, log_q, width, v, I, from, row_end,
+                                     [&](int u) { cell(u, v) = encodeWeight<W>(generatedPairWeight(params, v, u)); });
+        }
+    }
+}
+
+/**
+ * @brief Плотный блок строк [first_row, first_row + num_rows): out[r * n + v] = w(first_row + r, v).
+ */
+template <typename W>
+inline void generateDenseRows(const GeneratorParams &params, int countVertices, int first_row, int num_rows, W *out) {
+    generateDenseBlock(params, first_row, num_rows, 0, countVertices, out);
+}
+
+/**
+ * @brief Строки [first_row, first_row + num_rows) сразу в CSR, без плотной матрицы.
+ *
+ * Строки нумеруются локально с нуля, номера столбцов глобальные и возрастают, диагональ
+ * пропускается (как в buildCsrFromDenseRows). При density < 1 время пропорционально
+ * числу рёбер блока плюс O(n) на начала последовательностей.
+ */
+inline CsrGraph generateCsrRows(const GeneratorParams &params, int countVertices, int first_row, int num_rows) {
+    CsrGraph graph;
+    graph.num_vertices = num_rows;
+    graph.row_offsets.assign(num_rows + 1, 0);
+    const int row_end = first_row + num_rows;
+
+    if (params.density >= 1.0) {
+        graph.col_indices.reserve(static_cast<std::size_t>(num_rows) * (countVertices - 1));
+        graph.weights.reserve(graph.col_indices.capacity());
+        for (int r = 0; r < num_rows; ++r) {
+            int u = first_row + r;
+            for (int v = 0; v < countVertices; ++v) {
+                if (v == u) continue;
+                graph.col_indices.push_back(v);
+                graph.weights.push_back(u < v ? generatedPairWeight(params, u, v) : generatedPairWeight(params, v, u));
+            }
+            graph.row_offsets[r + 1] = static_cast<int>(graph.col_indices.size());
+        }
+        return graph;
+    }
+
+    const double log_q = std::log1p(-params.density);
+    const std::int64_t width = generatorBlockWidth(params);
+
+    // Соседи v < u: строки блока в последовательностях вершин v. Обход по возрастанию v,
+    // так что в каждой строке они накапливаются уже упорядоченными
+    struct Arc { int row; int col; };
+    std::vector<Arc> lower;
+    for (int v = 0; v + 1 < row_end; ++v) {
+        std::int64_t from = std::max(first_row, v + 1);
+        for (std::int64_t I = from / width; I * width < row_end; ++I) {
+            forEachGeneratedNeighbor(params, log_q, width, v, I, from, row_end, [&](int u) {
+                lower.push_back({u - first_row, v});
+                ++graph.row_offsets[u - first_row + 1];
+            });
+        }
+    }
+
+    std::vector<int> cursor(num_rows);
+    for (int r = 0; r < num_rows; ++r) {
+        cursor[r] = graph.row_offsets[r];
+        graph.row_offsets[r + 1] += graph.row_offsets[r];
+    }
+    graph.col_indices.resize(lower.size());
+    for (const Arc &arc : lower) graph.col_indices[cursor[arc.row]++] = arc.col;
+    std::vector<Arc>().swap(lower);
+
+    // Сдвигаем строки, дописывая к каждой соседей v > u
+    std::vector<int> lower_cols;
+    lower_cols.swap(graph.col_indices);
+    graph.col_indices.reserve(lower_cols.size() * 2 + num_rows);
+    graph.row_offsets[0] = 0;
+    int begin = 0;
+    for (int r = 0; r < num_rows; ++r) {
+        int u = first_row + r, end = cursor[r];
+        for (int k = begin; k < end; ++k) {
+            graph.col_indices.push_back(lower_cols[k]);
+            graph.weights.push_back(generatedPairWeight(params, lower_cols[k], u));
+        }
+        begin = end;
+        for (std::int64_t J = (u + 1) / width; J * width < countVertices; ++J) {
+            forEachGeneratedNeighbor(params, log_q, width, u, J, u + 1, countVertices, [&](int v) {
+                graph.col_indices.push_back(v);
+                graph.weights.push_back(generatedPairWeight(params, u, v));
+            });
+        }
+        graph.row_offsets[r + 1] = static_cast<int>(graph.col_indices.size());
+    }
+    return graph;
+}
+
+/**
+ * @brief Разбор параметров генератора: --seed=S, --density=P, --min-weight=A, --max-weight=B.
+ * @return true, если аргумент относится к генератору.
+ */
+inline bool parseGeneratorOption(const char *arg, GeneratorParams &params) {
+    std::string value;
+    if (parseOption(arg, "--seed", value)) {
+        params.seed = std::stoull(value);
+    } else if (parseOption(arg, "--density", value)) {
+        params.density = std::stod(value);
+    } else if (parseOption(arg, "--min-weight", value)) {
+        params.min_weight = std::stoi(value);
+    } else if (parseOption(arg, "--max-weight", value)) {
+        params.max_weight = std::stoi(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Проверка параметров генератора.
+ * @param error [out] Описание ошибки.
+ */
+inline bool validateGeneratorParams(const GeneratorParams &params, std::string &error) {
+    if (!(params.density > 0.0 && params.density <= 1.0)) {
+        error = "--density должна быть в диапазоне (0, 1]";
+        return false;
+    }
+    if (params.min_weight < 0 || params.min_weight > params.max_weight || params.max_weight >= INF) {
+        error = "ожидается 0 <= --min-weight <= --max-weight < INT_MAX";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "thread_team.hpp"
+
+/**
+ * Размещение больших массивов (матрица смежности, dist/pred) в памяти.
+ *
+ * Страницы:
+ *   small — обычные 4 КБ (MADV_NOHUGEPAGE);
+ *   thp   — прозрачные большие страницы 2 МБ (MADV_HUGEPAGE, начало выровнено на 2 МБ):
+ *           при потоковом проходе по матрице на порядки меньше промахов TLB;
+ *   huge  — явные страницы 2 МБ из пула hugetlbfs (MAP_HUGETLB, пул задаёт vm.nr_hugepages);
+ *           если пул пуст — откат на thp.
+ * NUMA:
+ *   default    — политика ядра: страница попадает на узел потока, первым записавшего в неё;
+ *   interleave — страницы по очереди на всех узлах (mbind MPOL_INTERLEAVE): равная нагрузка
+ *                на контроллеры памяти, когда к массиву обращаются все потоки;
+ *   partition  — массив делится на полосы так же, как строки делят потоки (процессы узла),
+ *                полоса закрепляется за узлом своего потока (MPOL_PREFERRED) и заполняется им.
+ *
+ * Память выделяется через mmap и сразу заполняется нулями по полосам в потоках, поэтому
+ * страницы выделяются при загрузке, а не при первом обращении в замеряемом расчёте.
+ * Фактическое размещение после откатов возвращает report().
+ */
+
+enum class PageMode { Small, Transparent, Huge };
+enum class NumaMode { Default, Interleave, Partition };
+
+inline bool parsePageMode(const std::string &text, PageMode &mode) {
+    if (text == "small") mode = PageMode::Small;
+    else if (text == "thp") mode = PageMode::Transparent;
+    else if (text == "huge") mode = PageMode::Huge;
+    else return false;
+    return true;
+}
+
+inline const char *pageModeName(PageMode mode) {
+    switch (mode) {
+        case PageMode::Transparent: return "thp";
+        case PageMode::Huge: return "huge";
+        default: return "small";
+    }
+}
+
+inline bool parseNumaMode(const std::string &text, NumaMode &mode) {
+    if (text == "default") mode = NumaMode::Default;
+    else if (text == "interleave") mode = NumaMode::Interleave;
+    else if (text == "partition") mode = NumaMode::Partition;
+    else return false;
+    return true;
+}
+
+inline const char *numaModeName(NumaMode mode) {
+    switch (mode) {
+        case NumaMode::Interleave: return "interleave";
+        case NumaMode::Partition: return "partition";
+        default: return "default";
+    }
+}
+
+/**
+ * @brief Запрошенное размещение массива.
+ */
+struct MemoryPlacement {
+    PageMode pages = PageMode::Transparent;
+    NumaMode numa = NumaMode::Default;
+    int parts = 1;      // полос (потоков), между которыми делятся строки массива
+    int first_node = 0; // узлы массива — first_node .. first_node + num_nodes - 1 среди узлов системы
+    int num_nodes = 0;  // 0 — все узлы (процесс MPI задаёт свой узел)
+};
+
+/**
+ * @brief Фактическое размещение массива после откатов.
+ */
+struct PlacementReport {
+    std::size_t bytes = 0;
+    PageMode pages = PageMode::Small;
+    std::size_t huge_bytes = 0;        // байт в страницах 2 МБ (для thp — по /proc/self/smaps)
+    NumaMode numa = NumaMode::Default;
+    int nodes = 1;                     // узлов, по которым распределён массив
+    int parts = 1;
+    std::string note;                  // причина отката
+
+    std::string describe() const {
+        char text[256];
+        int len = std::snprintf(text, sizeof(text), "%.1f MB, pages ", bytes / 1e6);
+        if (pages == PageMode::Huge) {
+            len += std::snprintf(text + len, sizeof(text) - len, "huge 2 MB (MAP_HUGETLB)");
+        } else if (pages == PageMode::Transparent) {
+            len += std::snprintf(text + len, sizeof(text) - len, "thp (%.1f MB in 2 MB pages)", huge_bytes / 1e6);
+        } else {
+            len += std::snprintf(text + len, sizeof(text) - len, "4 KB");
+        }
+        if (numa == NumaMode::Interleave) {
+            std::snprintf(text + len, sizeof(text) - len, ", numa interleave over %d nodes", nodes);
+        } else if (numa == NumaMode::Partition) {
+            std::snprintf(text + len, sizeof(text) - len, ", numa partition: %d bands over %d nodes", parts, nodes);
+        } else {
+            std::snprintf(text + len, sizeof(text) - len, ", numa default (first touch)");
+        }
+        return note.empty() ? std::string(text) : std::string(text) + " [" + note + "]";
+    }
+};
+
+namespace placement_detail {
+
+constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+inline std::size_t roundUp(std::size_t value, std::size_t step) { return (value + step - 1) / step * step; }
+
+// Номера узлов из /sys/devices/system/node/online ("0-3,5"); без sysfs — один узел 0
+inline std::vector<int> onlineNumaNodes() {
+    std::vector<int> nodes;
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    if (file >> list) {
+        std::size_t pos = 0;
+        while (pos < list.size()) {
+            std::size_t comma = list.find(',', pos);
+            std::string range = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            std::size_t dash = range.find('-');
+            int first = std::atoi(range.c_str());
+            int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+            for (int node = first; node <= last; ++node) nodes.push_back(node);
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+    }
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+// Политика mbind для диапазона страниц; системный вызов напрямую, без зависимости от libnuma
+inline bool bindRange(void *addr, std::size_t len, int mode, const std::vector<int> &nodes) {
+    constexpr int kMaskWords = 16;
+    unsigned long mask[kMaskWords] = {};
+    for (int node : nodes) {
+        if (node < 0 || node >= kMaskWords * 64) return false;
+        mask[node / 64] |= 1UL << (node % 64);
+    }
+    return ::syscall(SYS_mbind, addr, len, mode, mask, kMaskWords * 64, 0) == 0;
+}
+
+// Байт в прозрачных больших страницах у отображения, содержащего addr (поле AnonHugePages);
+// ядро может слить соседние отображения с одинаковыми флагами, тогда это оценка сверху
+inline std::size_t anonHugeBytes(const void *addr) {
+    std::ifstream smaps("/proc/self/smaps");
+    const auto target = reinterpret_cast<std::uintptr_t>(addr);
+    std::string line;
+    bool inside = false;
+    while (std::getline(smaps, line)) {
+        unsigned long begin = 0, end = 0;
+        if (std::sscanf(line.c_str(), "%lx-%lx ", &begin, &end) == 2) {
+            inside = begin <= target && target < end;
+        } else if (inside && line.compare(0, 14, "AnonHugePages:") == 0) {
+            return static_cast<std::size_t>(std::strtoull(line.c_str() + 14, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+}
+
+} // namespace placement_detail
+
+inline int numaNodeCount() { return static_cast<int>(placement_detail::onlineNumaNodes().size()); }
+
+/**
+ * @brief Массив фиксированного размера с заданным размещением страниц (замена std::vector
+ * для больших массивов движков). Содержимое после allocate() обнулено.
+ */
+template <typename T>
+class PlacedArray {
+public:
+    PlacedArray() = default;
+    PlacedArray(const PlacedArray &) = delete;
+    PlacedArray &operator=(const PlacedArray &) = delete;
+    ~PlacedArray() { release(); }
+
+    /**
+     * @brief Выделение count элементов; при нехватке памяти — std::bad_alloc, как у std::vector.
+     * Откаты (нет страниц hugetlbfs, один узел NUMA, ошибка mbind) не считаются ошибкой
+     * и отражаются в report().
+     */
+    void allocate(std::size_t count, const MemoryPlacement &placement) {
+        using namespace placement_detail;
+        release();
+        report_ = PlacementReport{};
+        if (count == 0) return;
+
+        const std::size_t bytes = count * sizeof(T);
+        const std::size_t small_page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        // Массиву меньше 2 МБ большая страница не сокращает промахов TLB, а память тратит
+        PageMode pages = bytes < kHugePageSize ? PageMode::Small : placement.pages;
+        if (pages == PageMode::Huge) {
+            void *addr = ::mmap(nullptr, roundUp(bytes, kHugePageSize), PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (addr != MAP_FAILED) {
+                map_ = addr;
+                map_bytes_ = roundUp(bytes, kHugePageSize);
+            } else {
+                pages = PageMode::Transparent;
+                report_.note = "MAP_HUGETLB failed (vm.nr_hugepages?), fell back to thp";
+            }
+        }
+        if (!map_) {
+            // Прозрачные большие страницы выделяются только в окнах, выровненных на 2 МБ: запас под выравнивание
+            const std::size_t slack = pages == PageMode::Transparent ? kHugePageSize : 0;
+            const std::size_t length = roundUp(bytes, pages == PageMode::Transparent ? kHugePageSize : small_page);
+            void *addr = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (addr == MAP_FAILED) throw std::bad_alloc();
+            auto *raw = static_cast<std::uint8_t *>(addr);
+            auto *aligned = reinterpret_cast<std::uint8_t *>(roundUp(reinterpret_cast<std::uintptr_t>(raw), slack ? slack : small_page));
+            if (aligned > raw) ::munmap(raw, aligned - raw);
+            if (raw + length + slack > aligned + length) ::munmap(aligned + length, raw + length + slack - (aligned + length));
+            map_ = aligned;
+            map_bytes_ = length;
+            if (::madvise(map_, map_bytes_, pages == PageMode::Transparent ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0 &&
+                pages == PageMode::Transparent) {
+                pages = PageMode::Small;
+                report_.note = "MADV_HUGEPAGE unsupported, using 4 KB pages";
+            }
+        }
+        data_ = static_cast<T *>(map_);
+        size_ = count;
+        report_.bytes = bytes;
+        report_.pages = pages;
+
+        // Полосы равного размера, как блоки строк потоков; границы — по страницам
+        const std::size_t page = pages == PageMode::Small ? small_page : kHugePageSize;
+        const int parts = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(std::max(1, placement.parts), map_bytes_ / page)));
+        auto band_begin = [&](int t) {
+            return t == parts ? map_bytes_ : bytes * static_cast<std::size_t>(t) / parts / page * page;
+        };
+        report_.parts = parts;
+
+        if (placement.numa != NumaMode::Default) applyNumaPolicy(placement, parts, band_begin);
+
+        // Первое касание: каждая полоса заполняется своим потоком
+        runThreadTeam(parts, [&](int t) {
+            std::memset(static_cast<std::uint8_t *>(map_) + band_begin(t), 0, band_begin(t + 1) - band_begin(t));
+        });
+
+        if (pages == PageMode::Huge) report_.huge_bytes = bytes;
+        else if (pages == PageMode::Transparent) report_.huge_bytes = std::min(anonHugeBytes(map_), bytes);
+    }
+
+    void release() {
+        if (map_) ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map_bytes_ = 0;
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    T *data() { return data_; }
+    const T *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T &operator[](std::size_t i) { return data_[i]; }
+    const T &operator[](std::size_t i) const { return data_[i]; }
+
+    const PlacementReport &report() const { return report_; }
+
+private:
+    template <typename BandBegin>
+    void applyNumaPolicy(const MemoryPlacement &placement, int parts, BandBegin band_begin) {
+        using namespace placement_detail;
+        const std::vector<int> online = onlineNumaNodes();
+        if (online.size() < 2) {
+            report_.note += std::string(report_.note.empty() ? "" : "; ") + "single NUMA node, numa policy skipped";
+            return;
+        }
+        std::vector<int> nodes;
+        const int count = placement.num_nodes > 0 ? std::min<int>(placement.num_nodes, online.size()) : static_cast<int>(online.size());
+        for (int i = 0; i < count; ++i) nodes.push_back(online[(placement.first_node + i) % online.size()]);
+
+        bool ok = true;
+        if (placement.numa == NumaMode::Interleave) {
+            ok = bindRange(map_, map_bytes_, MPOL_INTERLEAVE, nodes);
+        } else {
+            for (int t = 0; t < parts && ok; ++t) {
+                const int node = nodes[static_cast<std::size_t>(t) * nodes.size() / parts];
+                if (band_begin(t + 1) > band_begin(t)) {
+                    ok = bindRange(static_cast<std::uint8_t *>(map_) + band_begin(t), band_begin(t + 1) - band_begin(t), MPOL_PREFERRED, {node});
+                }
+            }
+        }
+        if (ok) {
+            report_.numa = placement.numa;
+            report_.nodes = static_cast<int>(nodes.size());
+        } else {
+            report_.note += std::string(report_.note.empty() ? "" : "; ") + "mbind failed, first-touch placement";
+        }
+    }
+
+    void *map_ = nullptr;
+    std::size_t map_bytes_ = 0;
+    T *data_ = nullptr;
+    std::size_t size_ = 0;
+    PlacementReport report_;
+};
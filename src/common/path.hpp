@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @brief Восстановление пути source -> target по массиву предшественников.
+ *
+ * Проход идёт от target по pred до source; число шагов ограничено countVertices,
+ * так что испорченный массив (цикл) не зацикливает вывод.
+ * @param pred Предшественники вершин (-1 — нет предшественника).
+ * @param countVertices Количество вершин.
+ * @return Вершины пути от source до target; пустой вектор, если target недостижима.
+ */
+inline std::vector<int> reconstructPath(const int *pred, int countVertices, int source, int target) {
+    std::vector<int> path;
+    for (int v = target; v != -1 && static_cast<int>(path.size()) <= countVertices; v = pred[v]) {
+        path.push_back(v);
+        if (v == source) {
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Вывод строки пути "Path (K hops): s -> ... -> t" (или "Path: none" для пустого пути).
+ */
+inline void printPathLine(const std::vector<int> &path) {
+    if (path.empty()) {
+        std::printf("Path: none\n\n");
+        return;
+    }
+    std::printf("Path (%zu hops):", path.size() - 1);
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        std::printf(i == 0 ? " %d" : " -> %d", path[i]);
+    }
+    std::printf("\n\n");
+}
+
+/**
+ * @brief Вывод результата запроса "точка — точка": расстояние, число обработанных вершин и путь.
+ * @param distance Расстояние до цели (отрицательное — цель недостижима).
+ * @param settled Число окончательно обработанных вершин до остановки.
+ * @param path Путь из reconstructPath.
+ */
+inline void printPathQuery(int source, int target, long long distance, long long settled, int countVertices, const std::vector<int> &path) {
+    if (distance < 0 || path.empty()) {
+        std::printf("Query: %d -> %d, unreachable, settled: %lld of %d\n", source, target, settled, countVertices);
+        printPathLine({});
+        return;
+    }
+    std::printf("Query: %d -> %d, distance: %lld, settled: %lld of %d\n", source, target, distance, settled, countVertices);
+    printPathLine(path);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Элемент очереди с приоритетом: текущее расстояние и вершина.
+ */
+struct QueueItem {
+    int dist;
+    int vertex;
+};
+
+/**
+ * @brief d-арная min-куча без операции decrease-key.
+ *
+ * Устаревшие элементы не удаляются, а пропускаются при извлечении
+ * (ленивое удаление), поэтому в куче может быть несколько копий вершины.
+ * @tparam Arity Число потомков узла (2 — бинарная куча, 4 — 4-арная).
+ */
+template <int Arity>
+class DaryHeap {
+    static_assert(Arity >= 2, "Arity must be at least 2");
+
+public:
+    bool empty() const { return items_.empty(); }
+    std::size_t size() const { return items_.size(); }
+    void clear() { items_.clear(); }
+
+    void push(QueueItem item) {
+        std::size_t pos = items_.size();
+        items_.push_back(item);
+
+        // Просеивание вверх
+        while (pos > 0) {
+            std::size_t parent = (pos - 1) / Arity;
+            if (items_[parent].dist <= item.dist) break;
+            items_[pos] = items_[parent];
+            pos = parent;
+        }
+        items_[pos] = item;
+    }
+
+    QueueItem pop() {
+        QueueItem top = items_.front();
+        QueueItem last = items_.back();
+        items_.pop_back();
+
+        std::size_t count = items_.size();
+        if (count == 0) return top;
+
+        // Просеивание вниз
+        std::size_t pos = 0;
+        while (true) {
+            std::size_t first_child = pos * Arity + 1;
+            if (first_child >= count) break;
+
+            std::size_t last_child = first_child + Arity;
+            if (last_child > count) last_child = count;
+
+            std::size_t best = first_child;
+            for (std::size_t c = first_child + 1; c < last_child; ++c) {
+                if (items_[c].dist < items_[best].dist) best = c;
+            }
+
+            if (last.dist <= items_[best].dist) break;
+            items_[pos] = items_[best];
+            pos = best;
+        }
+        items_[pos] = last;
+
+        return top;
+    }
+
+private:
+    std::vector<QueueItem> items_;
+};
+
+using BinaryHeap = DaryHeap<2>;
+using QuaternaryHeap = DaryHeap<4>;
+
+/**
+ * @brief Очередь Дайала (циклический массив корзин) для целых весов 0..max_weight.
+ *
+ * Корректна только для монотонной последовательности извлечений, как в Дейкстре:
+ * ключи не меньше последнего извлечённого (после clear() — не меньше 0),
+ * и все ключи в очереди лежат в [current, current + max_weight], поэтому
+ * достаточно max_weight + 1 корзин. push/pop — O(1) амортизированно.
+ */
+class DialQueue {
+public:
+    explicit DialQueue(int max_weight)
+        : buckets_(static_cast<std::size_t>(max_weight) + 1) {}
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void clear() {
+        for (auto &bucket : buckets_) bucket.clear();
+        size_ = 0;
+        current_dist_ = 0;
+    }
+
+    void push(QueueItem item) {
+        buckets_[static_cast<std::size_t>(item.dist) % buckets_.size()].push_back(item.vertex);
+        ++size_;
+    }
+
+    QueueItem pop() {
+        std::size_t index = static_cast<std::size_t>(current_dist_) % buckets_.size();
+        while (buckets_[index].empty()) {
+            ++current_dist_;
+            index = (index + 1 == buckets_.size()) ? 0 : index + 1;
+        }
+
+        int vertex = buckets_[index].back();
+        buckets_[index].pop_back();
+        --size_;
+
+        return {current_dist_, vertex};
+    }
+
+private:
+    std::vector<std::vector<int>> buckets_;
+    std::size_t size_ = 0;
+    int current_dist_ = 0;
+};
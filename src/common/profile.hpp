@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * Встроенное профилирование горячего пути (--profile).
+ *
+ * Движки получают указатель RunProfile* (nullptr — профилирование выключено) и накапливают
+ * время по фазам, объём коммуникаций и счётчики релаксаций. Таймер — steady_clock,
+ * два вызова на фазу; при выключенном профилировании остаётся только проверка указателя.
+ */
+enum ProfilePhase {
+    kPhaseSelect,   // выбор вершины: поиск минимума / извлечение из очереди / поиск корзины
+    kPhaseRelax,    // релаксация рёбер
+    kPhaseReduce,   // MPI_Allreduce (MINLOC, номер корзины, флаг работы)
+    kPhaseBcast,    // MPI_Bcast строки смежности
+    kPhaseExchange, // MPI_Alltoallv запросов релаксации
+    kPhaseWait,     // ожидание на барьерах: дисбаланс нагрузки
+    kPhaseCount
+};
+
+inline const char *profilePhaseName(int phase) {
+    static const char *const names[kPhaseCount] = {"select", "relax", "reduce", "bcast", "exchange", "wait"};
+    return names[phase];
+}
+
+/**
+ * @brief Накопленные показатели одного запуска (одного процесса).
+ */
+struct RunProfile {
+    double phase_seconds[kPhaseCount] = {};
+    std::uint64_t bytes = 0;            // полезная нагрузка коллективных операций (отправлено + получено)
+    std::uint64_t relax_attempted = 0;  // проверенные кандидаты (рёбра / непосещённые ячейки строки)
+    std::uint64_t relax_successful = 0; // улучшенные расстояния
+    std::uint64_t iterations = 0;       // выбранные вершины (для delta-stepping — корзины) до выхода
+};
+
+/**
+ * @brief Замер фазы в области видимости: время добавляется в profile->phase_seconds[phase].
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(RunProfile *profile, ProfilePhase phase) : profile_(profile), phase_(phase) {
+        if (profile_) start_ = std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer() { stop(); }
+
+    void stop() {
+        if (!profile_) return;
+        profile_->phase_seconds[phase_] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        profile_ = nullptr;
+    }
+
+private:
+    RunProfile *profile_;
+    ProfilePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Вывод профиля последовательного запуска: фазы с долей от времени счёта и счётчики.
+ */
+inline void printProfile(const RunProfile &profile, double compute_seconds) {
+    std::printf("Profile:\n");
+    for (int phase = 0; phase < kPhaseCount; ++phase) {
+        if (profile.phase_seconds[phase] == 0.0) continue;
+        std::printf("  %-10s %.6f s (%5.1f%%)\n", profilePhaseName(phase), profile.phase_seconds[phase],
+                    compute_seconds > 0 ? 100.0 * profile.phase_seconds[phase] / compute_seconds : 0.0);
+    }
+    std::printf("  relaxations: %llu attempted, %llu successful\n",
+                static_cast<unsigned long long>(profile.relax_attempted), static_cast<unsigned long long>(profile.relax_successful));
+    std::printf("  iterations: %llu\n\n", static_cast<unsigned long long>(profile.iterations));
+}
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "path.hpp"
+
+/**
+ * Режим сервера (--serve): граф загружается один раз, затем обрабатываются запросы.
+ *
+ * Протокол строковый, одна строка — один запрос, один ответ — одна строка:
+ *   "S"      — дерево кратчайших путей от S: "S reachable=R/N max_distance=D ...";
+ *   "S T"    — путь S -> T: "S -> T distance=D hops=H path=S,...,T ...";
+ *   "stats"  — счётчики сервера; "quit" — завершение сервера.
+ * Каждый ответ заканчивается полями cache=hit|miss и latency_us (время от приёма строки
+ * до готового ответа). Ошибки — строка "error: ...".
+ */
+
+/**
+ * @brief Дерево кратчайших путей от одного источника в кэше сервера.
+ *
+ * Расстояния хранятся в 64 битах независимо от типа расстояний движка; -1 — вершина недостижима.
+ */
+struct ShortestPathTree {
+    int source = -1;
+    std::vector<std::int64_t> dist;
+    std::vector<int> pred;
+    int settled = 0; // вершины, обработанные при построении
+};
+
+/**
+ * @brief LRU-кэш деревьев кратчайших путей по источнику.
+ *
+ * При вытеснении буферы самого старого дерева переиспользуются для нового,
+ * поэтому после заполнения кэша промахи не выделяют память.
+ */
+class ShortestPathCache {
+public:
+    explicit ShortestPathCache(std::size_t capacity) : capacity_(capacity) {}
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t capacity() const { return capacity_; }
+
+    // Дерево источника или nullptr; найденное дерево становится самым свежим
+    const ShortestPathTree *find(int source) {
+        auto it = index_.find(source);
+        if (it == index_.end()) return nullptr;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &entries_.front();
+    }
+
+    // Место под дерево нового источника (capacity() > 0): вытесняет самое старое при переполнении
+    ShortestPathTree &acquire(int source) {
+        if (entries_.size() >= capacity_) {
+            index_.erase(entries_.back().source);
+            entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+        } else {
+            entries_.emplace_front();
+        }
+        entries_.front().source = source;
+        index_[source] = entries_.begin();
+        return entries_.front();
+    }
+
+    void erase(int source) {
+        auto it = index_.find(source);
+        if (it == index_.end()) return;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+private:
+    std::size_t capacity_;
+    std::list<ShortestPathTree> entries_; // от самого свежего к самому старому
+    std::unordered_map<int, std::list<ShortestPathTree>::iterator> index_;
+};
+
+/**
+ * @brief Построчный канал запросов: стандартный ввод/вывод или локальный Unix-сокет.
+ *
+ * В режиме сокета клиенты обслуживаются по очереди: после отключения клиента
+ * сервер ждёт следующего. Файл сокета удаляется при закрытии канала.
+ */
+class QueryChannel {
+public:
+    QueryChannel() = default;
+    QueryChannel(const QueryChannel &) = delete;
+    QueryChannel &operator=(const QueryChannel &) = delete;
+    ~QueryChannel() { close(); }
+
+    void openStdio() {
+        in_fd_ = STDIN_FILENO;
+        out_fd_ = STDOUT_FILENO;
+    }
+
+    bool openSocket(const std::string &path, std::string &error) {
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            error = "слишком длинный или пустой путь сокета";
+            return false;
+        }
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            error = "не удалось создать сокет";
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        path.copy(addr.sun_path, path.size());
+        ::unlink(path.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd_, 4) != 0) {
+            error = "не удалось открыть сокет " + path;
+            close();
+            return false;
+        }
+        socket_path_ = path;
+        return true;
+    }
+
+    /**
+     * @brief Следующая строка запроса (без '\n' и '\r').
+     * @return false — ввод закончился (конец stdin или ошибка приёма соединения).
+     */
+    bool readLine(std::string &line) {
+        while (true) {
+            std::size_t newline = buffer_.find('\n');
+            if (newline != std::string::npos) {
+                line.assign(buffer_, 0, newline);
+                buffer_.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            if (in_fd_ < 0) {
+                if (listen_fd_ < 0) return false;
+                int client = ::accept(listen_fd_, nullptr, nullptr);
+                if (client < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                in_fd_ = out_fd_ = client;
+                continue;
+            }
+
+            char chunk[4096];
+            ssize_t received = ::read(in_fd_, chunk, sizeof(chunk));
+            if (received > 0) {
+                buffer_.append(chunk, static_cast<std::size_t>(received));
+                continue;
+            }
+            if (received < 0 && errno == EINTR) continue;
+            if (!buffer_.empty()) {
+                // Последняя строка без перевода строки; соединение закроется при следующем чтении
+                line.swap(buffer_);
+                buffer_.clear();
+                return true;
+            }
+            if (listen_fd_ < 0) return false;
+            ::close(in_fd_);
+            in_fd_ = out_fd_ = -1;
+        }
+    }
+
+    // Ответ текущему клиенту; отключившийся клиент не прерывает сервер (MSG_NOSIGNAL вместо SIGPIPE)
+    void writeLine(const std::string &text) {
+        if (out_fd_ < 0) return;
+        std::string message = text + "\n";
+        std::size_t sent = 0;
+        while (sent < message.size()) {
+            ssize_t written = listen_fd_ >= 0 ? ::send(out_fd_, message.data() + sent, message.size() - sent, MSG_NOSIGNAL)
+                                              : ::write(out_fd_, message.data() + sent, message.size() - sent);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            sent += static_cast<std::size_t>(written);
+        }
+    }
+
+    std::string description() const { return listen_fd_ >= 0 ? "socket " + socket_path_ : "stdin"; }
+
+    void close() {
+        if (listen_fd_ >= 0) {
+            if (in_fd_ >= 0) ::close(in_fd_);
+            ::close(listen_fd_);
+            ::unlink(socket_path_.c_str());
+        }
+        listen_fd_ = in_fd_ = out_fd_ = -1;
+    }
+
+private:
+    int listen_fd_ = -1;
+    int in_fd_ = -1;
+    int out_fd_ = -1;
+    std::string socket_path_;
+    std::string buffer_;
+};
+
+namespace query_server_detail {
+
+inline double percentile(std::vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    // Метод ближайшего ранга, как в bench/run_bench.py
+    std::size_t rank = static_cast<std::size_t>(std::ceil(q / 100.0 * static_cast<double>(values.size())));
+    return values[std::max<std::size_t>(rank, 1) - 1];
+}
+
+inline std::string formatTreeReply(const ShortestPathTree &tree, int target, int countVertices) {
+    std::ostringstream reply;
+    if (target < 0) {
+        int reachable = 0;
+        std::int64_t max_distance = 0;
+        for (std::int64_t d : tree.dist) {
+            if (d < 0) continue;
+            ++reachable;
+            max_distance = std::max(max_distance, d);
+        }
+        reply << tree.source << " reachable=" << reachable << "/" << countVertices << " max_distance=" << max_distance;
+    } else {
+        reply << tree.source << " -> " << target;
+        std::vector<int> path = tree.dist[target] < 0 ? std::vector<int>() : reconstructPath(tree.pred.data(), countVertices, tree.source, target);
+        if (path.empty()) {
+            reply << " distance=inf path=none";
+        } else {
+            reply << " distance=" << tree.dist[target] << " hops=" << path.size() - 1 << " path=";
+            for (std::size_t i = 0; i < path.size(); ++i) reply << (i == 0 ? "" : ",") << path[i];
+        }
+    }
+    reply << " settled=" << tree.settled;
+    return reply.str();
+}
+
+} // namespace query_server_detail
+
+/**
+ * @brief Цикл сервера запросов: разбор строк, кэш деревьев, вызов движка, ответы и задержки.
+ *
+ * При непустом кэше промах строит полное дерево источника (его можно переиспользовать
+ * для любой цели). Без кэша (--cache=0) запрос с целью строится с ранней остановкой.
+ *
+ * @param solve Функция bool(int source, int target, ShortestPathTree &tree, std::string &error):
+ *              заполняет tree.dist, tree.pred и tree.settled (target = -1 — полное дерево).
+ * @return Число обработанных запросов.
+ */
+template <typename Solve>
+inline int runQueryServer(QueryChannel &channel, int countVertices, std::size_t cache_capacity, Solve &&solve) {
+    using namespace query_server_detail;
+    using steady_clock = std::chrono::steady_clock;
+
+    ShortestPathCache cache(cache_capacity);
+    ShortestPathTree scratch; // дерево запроса при выключенном кэше
+    std::vector<double> latencies_us;
+    int hits = 0, misses = 0, errors = 0;
+
+    std::string line;
+    while (channel.readLine(line)) {
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first) || first[0] == '#') continue;
+        if (first == "quit") break;
+        if (first == "stats") {
+            std::ostringstream reply;
+            reply << "queries=" << latencies_us.size() << " hits=" << hits << " misses=" << misses << " errors=" << errors
+                  << " cache=" << cache.size() << "/" << cache.capacity()
+                  << " p50_us=" << percentile(latencies_us, 50) << " p95_us=" << percentile(latencies_us, 95);
+            channel.writeLine(reply.str());
+            continue;
+        }
+
+        steady_clock::time_point received = steady_clock::now();
+        int source = -1, target = -1;
+        std::string extra;
+        std::istringstream numbers(line);
+        bool parsed = static_cast<bool>(numbers >> source);
+        if (parsed && !(numbers >> std::ws).eof()) parsed = (numbers >> target) && !(numbers >> extra);
+        if (!parsed) {
+            ++errors;
+            channel.writeLine("error: ожидается \"S\", \"S T\", \"stats\" или \"quit\"");
+            continue;
+        }
+        if (source < 0 || source >= countVertices || target < -1 || target >= countVertices) {
+            ++errors;
+            channel.writeLine("error: вершина вне диапазона [0, " + std::to_string(countVertices) + ")");
+            continue;
+        }
+
+        const ShortestPathTree *tree = cache.find(source);
+        const bool hit = tree != nullptr;
+        if (!hit) {
+            ShortestPathTree &slot = cache_capacity > 0 ? cache.acquire(source) : scratch;
+            slot.source = source;
+            std::string error;
+            if (!solve(source, cache_capacity > 0 ? -1 : target, slot, error)) {
+                if (cache_capacity > 0) cache.erase(source);
+                ++errors;
+                channel.writeLine("error: " + error);
+                continue;
+            }
+            tree = &slot;
+        }
+        std::string reply = formatTreeReply(*tree, target, countVertices);
+        double latency = std::chrono::duration<double, std::micro>(steady_clock::now() - received).count();
+
+        hit ? ++hits : ++misses;
+        latencies_us.push_back(latency);
+        char tail[64];
+        std::snprintf(tail, sizeof(tail), " cache=%s latency_us=%.1f", hit ? "hit" : "miss", latency);
+        channel.writeLine(reply + tail);
+    }
+
+    std::fprintf(stderr, "Server: %zu queries (%d cache hits, %d misses, %d errors), latency p50 %.1f us, p95 %.1f us\n",
+                 latencies_us.size(), hits, misses, errors, percentile(latencies_us, 50), percentile(latencies_us, 95));
+    return static_cast<int>(latencies_us.size());
+}
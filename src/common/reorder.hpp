@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+
+/**
+ * Перенумерация вершин разреженного графа для локальности обращений к dist/pred.
+ *
+ * Перестановка задаётся парой массивов: order[new] = old (вершина, получившая номер new)
+ * и new_id[old] = new. Дейкстра идёт по перенумерованному графу, результаты
+ * переводятся обратно к исходным номерам (restoreOriginalIds).
+ */
+
+enum class VertexOrder { None, Rcm, Degree, Bfs };
+
+inline bool parseVertexOrder(const std::string &text, VertexOrder &order) {
+    if (text == "none") order = VertexOrder::None;
+    else if (text == "rcm") order = VertexOrder::Rcm;
+    else if (text == "degree") order = VertexOrder::Degree;
+    else if (text == "bfs") order = VertexOrder::Bfs;
+    else return false;
+    return true;
+}
+
+inline const char *vertexOrderName(VertexOrder order) {
+    switch (order) {
+        case VertexOrder::Rcm: return "rcm";
+        case VertexOrder::Degree: return "degree";
+        case VertexOrder::Bfs: return "bfs";
+        default: return "none";
+    }
+}
+
+/**
+ * @brief Перестановка вершин графа: пара взаимно обратных массивов.
+ */
+struct VertexPermutation {
+    std::vector<int> order;  // order[new] = old
+    std::vector<int> new_id; // new_id[old] = new
+};
+
+namespace reorder_detail {
+
+inline int degree(const CsrGraph &graph, int u) { return graph.row_offsets[u + 1] - graph.row_offsets[u]; }
+
+// Обход в ширину от start по ещё не посещённым вершинам; соседи — в порядке CSR
+// или по возрастанию степени (Cuthill — McKee). Возвращает эксцентриситет start в компоненте.
+inline int appendBfs(const CsrGraph &graph, int start, bool by_degree, std::vector<char> &visited, std::vector<int> &order) {
+    std::size_t head = order.size();
+    std::vector<int> neighbours;
+    std::vector<int> level_end{static_cast<int>(head) + 1};
+    visited[start] = 1;
+    order.push_back(start);
+    int depth = 0;
+    for (; head < order.size(); ++head) {
+        if (static_cast<int>(head) == level_end.back()) {
+            level_end.push_back(static_cast<int>(order.size()));
+            ++depth;
+        }
+        int u = order[head];
+        neighbours.clear();
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            int v = graph.col_indices[e];
+            if (visited[v]) continue;
+            visited[v] = 1;
+            neighbours.push_back(v);
+        }
+        if (by_degree) {
+            std::stable_sort(neighbours.begin(), neighbours.end(),
+                             [&](int a, int b) { return degree(graph, a) < degree(graph, b); });
+        }
+        order.insert(order.end(), neighbours.begin(), neighbours.end());
+    }
+    return depth;
+}
+
+// Псевдопериферийная вершина компоненты start: повторные обходы от вершины
+// минимальной степени последнего уровня, пока эксцентриситет растёт (Гиббс — Пул — Стокмейер)
+inline int pseudoPeripheral(const CsrGraph &graph, int start, std::vector<char> &scratch_visited, std::vector<int> &scratch_order) {
+    int best = start, best_depth = -1;
+    for (int round = 0; round < 8; ++round) {
+        scratch_order.clear();
+        int depth = appendBfs(graph, best, false, scratch_visited, scratch_order);
+        for (int v : scratch_order) scratch_visited[v] = 0;
+        if (depth <= best_depth) break;
+        best_depth = depth;
+
+        // Последний уровень — хвост обхода с наибольшим расстоянием; берём вершину минимальной степени
+        int candidate = scratch_order.back();
+        for (auto it = scratch_order.rbegin(); it != scratch_order.rend(); ++it) {
+            if (degree(graph, *it) < degree(graph, candidate)) candidate = *it;
+            if (it - scratch_order.rbegin() > 64) break; // достаточно хвоста последнего уровня
+        }
+        if (candidate == best) break;
+        best = candidate;
+    }
+    return best;
+}
+
+} // namespace reorder_detail
+
+/**
+ * @brief Перестановка вершин для локальности.
+ *
+ * rcm    — обратный Катхилл — Макки: обход в ширину от псевдопериферийной вершины
+ *          каждой компоненты, соседи по возрастанию степени, затем порядок обращается;
+ *          концы рёбер получают близкие номера (малая ширина ленты);
+ * bfs    — обход в ширину от вершины 0 (и от наименьшей непосещённой для остальных компонент);
+ * degree — по убыванию степени: вершины-концентраторы, к которым обращаются чаще всего,
+ *          собираются в начале массивов.
+ * Обходы идут по исходящим дугам: для ориентированного графа порядок зависит от направления.
+ */
+inline VertexPermutation computeVertexOrder(const CsrGraph &graph, VertexOrder kind) {
+    using namespace reorder_detail;
+    const int n = graph.num_vertices;
+    VertexPermutation perm;
+    perm.order.reserve(n);
+
+    if (kind == VertexOrder::Degree) {
+        perm.order.resize(n);
+        std::iota(perm.order.begin(), perm.order.end(), 0);
+        std::stable_sort(perm.order.begin(), perm.order.end(), [&](int a, int b) { return degree(graph, a) > degree(graph, b); });
+    } else if (kind == VertexOrder::Bfs || kind == VertexOrder::Rcm) {
+        std::vector<char> visited(n, 0), scratch_visited;
+        std::vector<int> scratch_order;
+        if (kind == VertexOrder::Rcm) scratch_visited.assign(n, 0);
+        for (int s = 0; s < n; ++s) {
+            if (visited[s]) continue;
+            int root = kind == VertexOrder::Rcm ? pseudoPeripheral(graph, s, scratch_visited, scratch_order) : s;
+            appendBfs(graph, root, kind == VertexOrder::Rcm, visited, perm.order);
+        }
+        if (kind == VertexOrder::Rcm) std::reverse(perm.order.begin(), perm.order.end());
+    } else {
+        perm.order.resize(n);
+        std::iota(perm.order.begin(), perm.order.end(), 0);
+    }
+
+    perm.new_id.resize(n);
+    for (int k = 0; k < n; ++k) perm.new_id[perm.order[k]] = k;
+    return perm;
+}
+
+/**
+ * @brief Граф в новой нумерации: строка new — соседи вершины order[new],
+ * номера соседей переведены и отсортированы по возрастанию.
+ */
+inline CsrGraph permuteCsr(const CsrGraph &graph, const VertexPermutation &perm) {
+    const int n = graph.num_vertices;
+    CsrGraph result;
+    result.num_vertices = n;
+    result.row_offsets.assign(n + 1, 0);
+    result.col_indices.resize(graph.col_indices.size());
+    result.weights.resize(graph.weights.size());
+
+    std::vector<std::pair<int, int>> row; // {новый номер соседа, вес}
+    for (int k = 0; k < n; ++k) {
+        int u = perm.order[k];
+        row.clear();
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            row.push_back({perm.new_id[graph.col_indices[e]], graph.weights[e]});
+        }
+        std::sort(row.begin(), row.end());
+        int pos = result.row_offsets[k];
+        for (const auto &arc : row) {
+            result.col_indices[pos] = arc.first;
+            result.weights[pos] = arc.second;
+            ++pos;
+        }
+        result.row_offsets[k + 1] = pos;
+    }
+    return result;
+}
+
+/**
+ * @brief Перевод dist/pred из новой нумерации в исходную.
+ * @param dist [in/out] На входе dist[new], на выходе dist[old].
+ * @param pred [in/out] Предки в новой нумерации -> предки в исходной (-1 сохраняется).
+ */
+template <typename D>
+inline void restoreOriginalIds(const VertexPermutation &perm, D *dist, int *pred) {
+    const int n = static_cast<int>(perm.order.size());
+    std::vector<D> new_dist(dist, dist + n);
+    std::vector<int> new_pred(pred, pred + n);
+    for (int v = 0; v < n; ++v) {
+        int k = perm.new_id[v];
+        dist[v] = new_dist[k];
+        pred[v] = new_pred[k] == -1 ? -1 : perm.order[new_pred[k]];
+    }
+}
+
+/**
+ * @brief Показатели локальности нумерации: ширина ленты (max |u - v|) и средний разнос концов дуги.
+ */
+struct OrderingQuality {
+    int bandwidth = 0;
+    double mean_span = 0.0;
+};
+
+inline OrderingQuality orderingQuality(const CsrGraph &graph) {
+    OrderingQuality quality;
+    std::uint64_t total = 0;
+    for (int u = 0; u < graph.num_vertices; ++u) {
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            int span = std::abs(graph.col_indices[e] - u);
+            quality.bandwidth = std::max(quality.bandwidth, span);
+            total += static_cast<std::uint64_t>(span);
+        }
+    }
+    if (graph.numEdges() > 0) quality.mean_span = static_cast<double>(total) / graph.numEdges();
+    return quality;
+}
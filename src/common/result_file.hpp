@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "weight_types.hpp"
+
+/**
+ * Бинарный файл результата расчёта от одного источника (порядок байт машины):
+ *
+ *   ResultFileHeader (64 байта)
+ *   dist[n] — int32 или int64 (dist_bytes), недостижимая вершина — максимум типа (INF)
+ *   pred[n] — int32, -1 — нет предшественника; секция выровнена на 8 байт
+ *
+ * Смещения секций зависят только от n и ширины расстояния, поэтому каждый процесс MPI
+ * пишет свой отрезок вершин сам (MPI_File_write_at_all), без сбора массивов на процессе 0.
+ * Если расчёт шёл с --target, точны только расстояния обработанных вершин (и путь до цели).
+ */
+constexpr char kResultFileMagic[8] = {'S', 'S', 'S', 'P', 'R', 'E', 'S', '1'};
+constexpr std::uint32_t kResultFileVersion = 1;
+
+struct ResultFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dist_bytes;   // 4 или 8
+    std::uint64_t num_vertices;
+    std::int64_t source;
+    std::int64_t target;        // -1 — полное дерево кратчайших путей
+    std::uint64_t dist_offset;
+    std::uint64_t pred_offset;
+    std::uint8_t reserved[8];
+};
+static_assert(sizeof(ResultFileHeader) == 64, "ResultFileHeader must be 64 bytes");
+
+inline ResultFileHeader makeResultHeader(int countVertices, int source, int target, std::uint32_t dist_bytes) {
+    ResultFileHeader header{};
+    std::memcpy(header.magic, kResultFileMagic, sizeof(header.magic));
+    header.version = kResultFileVersion;
+    header.dist_bytes = dist_bytes;
+    header.num_vertices = static_cast<std::uint64_t>(countVertices);
+    header.source = source;
+    header.target = target;
+    header.dist_offset = sizeof(ResultFileHeader);
+    header.pred_offset = alignTo8(header.dist_offset + header.num_vertices * dist_bytes);
+    return header;
+}
+
+inline std::uint64_t resultFileSize(const ResultFileHeader &header) {
+    return header.pred_offset + header.num_vertices * sizeof(std::int32_t);
+}
+
+/**
+ * @brief Запись результата одним проходом: заголовок и массивы dist/pred без промежуточных копий.
+ * @tparam D Тип расстояний (int или int64_t).
+ * @return false при ошибке ввода-вывода.
+ */
+template <typename D>
+inline bool writeResultFile(const std::string &path, int countVertices, int source, int target, const D *dist, const int *pred) {
+    const ResultFileHeader header = makeResultHeader(countVertices, source, target, sizeof(D));
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    const char padding[8] = {};
+    const std::size_t n = static_cast<std::size_t>(countVertices);
+    const std::size_t pad = header.pred_offset - header.dist_offset - n * sizeof(D);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(dist, sizeof(D), n, file) == n &&
+              std::fwrite(padding, 1, pad, file) == pad &&
+              std::fwrite(pred, sizeof(int), n, file) == n;
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * @brief Файл результата, отображённый в память: массивы читаются по требованию, без загрузки целиком.
+ */
+class MappedResultFile {
+public:
+    MappedResultFile() = default;
+    MappedResultFile(const MappedResultFile &) = delete;
+    MappedResultFile &operator=(const MappedResultFile &) = delete;
+    ~MappedResultFile() { close(); }
+
+    bool open(const std::string &path, std::string &error) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "не удалось открыть " + path;
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(ResultFileHeader)) {
+            ::close(fd);
+            error = "файл слишком мал для заголовка результата";
+            return false;
+        }
+
+        size_ = static_cast<std::size_t>(st.st_size);
+        void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            size_ = 0;
+            error = "ошибка mmap для " + path;
+            return false;
+        }
+        data_ = static_cast<const std::uint8_t *>(addr);
+        std::memcpy(&header_, data_, sizeof(header_));
+
+        if (std::memcmp(header_.magic, kResultFileMagic, sizeof(kResultFileMagic)) != 0 || header_.version != kResultFileVersion ||
+            (header_.dist_bytes != 4 && header_.dist_bytes != 8) || header_.num_vertices > static_cast<std::uint64_t>(INF) ||
+            header_.source < 0 || static_cast<std::uint64_t>(header_.source) >= header_.num_vertices) {
+            error = "неверный заголовок файла результата";
+            close();
+            return false;
+        }
+        if (header_.pred_offset < header_.dist_offset + header_.num_vertices * header_.dist_bytes || resultFileSize(header_) > size_) {
+            error = "файл результата обрезан";
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (data_) ::munmap(const_cast<std::uint8_t *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const ResultFileHeader &header() const { return header_; }
+    int numVertices() const { return static_cast<int>(header_.num_vertices); }
+    int source() const { return static_cast<int>(header_.source); }
+
+    // Расстояние до v; -1 — вершина недостижима
+    long long distance(int v) const {
+        const std::uint8_t *cell = data_ + header_.dist_offset + static_cast<std::size_t>(v) * header_.dist_bytes;
+        if (header_.dist_bytes == 4) {
+            std::int32_t d;
+            std::memcpy(&d, cell, sizeof(d));
+            return d == INF ? -1 : d;
+        }
+        std::int64_t d;
+        std::memcpy(&d, cell, sizeof(d));
+        return d == distInfinity<std::int64_t>() ? -1 : d;
+    }
+
+    const int *pred() const { return reinterpret_cast<const int *>(data_ + header_.pred_offset); }
+
+private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    ResultFileHeader header_{};
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "graph.hpp"
+#include "graph_generator.hpp"
+#include "weight_types.hpp"
+
+/**
+ * Блоки строк плотной матрицы для движков с рассылкой строки выбранной вершины.
+ *
+ * DenseRowBlock — полная раскладка (n весов на строку), PackedRowBlock — упакованная
+ * симметричная (около n/2 весов на строку). Оба — представления над чужим буфером
+ * с общим интерфейсом, поэтому движок пишется один раз как шаблон по блоку строк:
+ *   rowLength()  — число хранимых весов строки (столько владелец рассылает за итерацию);
+ *   storedRow()  — хранимая часть строки u подряд (при необходимости собранная в scratch);
+ *   rowWeights() — веса w(u, first + k) отрезка вершин по хранимой части строки u.
+ */
+
+/**
+ * @brief Блок подряд идущих полных строк: data[r * n + v] = w(first_row + r, v).
+ */
+template <typename W>
+struct DenseRowBlock {
+    const W *data = nullptr;
+    int num_vertices = 0;
+    int first_row = 0;
+
+    int rowLength() const { return num_vertices; }
+    const W *storedRow(int u, W *) const { return data + static_cast<std::size_t>(u - first_row) * num_vertices; }
+
+    // Полная строка уже содержит веса отрезка подряд: копирование не нужно
+    const W *rowWeights(const W *row_u, int, int first, int, W *) const { return row_u + first; }
+};
+
+/**
+ * @brief Упакованная симметричная матрица из плиток kTile x kTile, уложенных «половиной кольца».
+ *
+ * Вершины делятся на T = ceil(n / kTile) полос. Полоса I хранит плитки (I, (I + k) mod T)
+ * для k = 0..T/2, плитка — kTile строк по kTile весов подряд. Каждая пара вершин хранится
+ * один раз (при чётном T пары полос на расстоянии T/2 — дважды), так что матрица занимает
+ * около n^2 / 2 весов. В отличие от верхнего треугольника все полосы одной длины:
+ * блочное разбиение строк по процессам и потокам остаётся равномерным.
+ *
+ * Строка u собирается из двух частей: своей полосы (строка u в каждой плитке — kTile весов
+ * подряд) и столбца u в плитках чужих полос. Столбец плитки из байтовых весов — одна
+ * кэш-строка, поэтому на kTile весов столбцовой части приходится одно обращение к памяти,
+ * а не kTile, как при поэлементном хранении.
+ *
+ * first_row — первая вершина блока; блок хранит все полосы, пересекающие его вершины
+ * (на границах блоков процессов полоса может храниться у двух соседей).
+ */
+template <typename W>
+struct PackedRowBlock {
+    static constexpr int kTile = 8;
+
+    const W *data = nullptr;
+    int num_vertices = 0;
+    int first_row = 0;
+
+    static int tileCount(int countVertices) { return (countVertices + kTile - 1) / kTile; }
+    static int tilesPerRow(int countVertices) { return tileCount(countVertices) / 2 + 1; }
+    static int packedRowLength(int countVertices) { return tilesPerRow(countVertices) * kTile; }
+    static std::size_t tileRowSize(int countVertices) { return static_cast<std::size_t>(tilesPerRow(countVertices)) * kTile * kTile; }
+
+    // Полосы, пересекающие вершины [first_vertex, first_vertex + count)
+    static int firstTileRow(int first_vertex) { return first_vertex / kTile; }
+    static int numTileRows(int first_vertex, int count) { return (first_vertex + count - 1) / kTile - first_vertex / kTile + 1; }
+    static std::size_t blockSize(int countVertices, int first_vertex, int count) { return numTileRows(first_vertex, count) * tileRowSize(countVertices); }
+
+    // Смещение j от i по кольцу длины size, [0, size)
+    static int ringOffset(int size, int i, int j) {
+        int offset = j - i;
+        return offset < 0 ? offset + size : offset;
+    }
+
+    int rowLength() const { return packedRowLength(num_vertices); }
+
+    // Плитка k полосы I
+    const W *tile(int I, int k) const {
+        return data + (static_cast<std::size_t>(I - firstTileRow(first_row)) * tilesPerRow(num_vertices) + k) * (kTile * kTile);
+    }
+
+    // Хранимая часть строки u: scratch[k * kTile + c] = w(u, ((u / kTile + k) mod T) * kTile + c)
+    const W *storedRow(int u, W *scratch) const {
+        const int I = u / kTile, r = u % kTile;
+        for (int k = 0; k < tilesPerRow(num_vertices); ++k) {
+            std::memcpy(scratch + k * kTile, tile(I, k) + r * kTile, kTile * sizeof(W));
+        }
+        return scratch;
+    }
+
+    /**
+     * @brief Веса строки u для вершин [first, first + count): out[k] = w(u, first + k).
+     *
+     * Полосы вершин отрезка, не покрытые хранимой частью строки u, должны лежать в блоке.
+     * @param row_u Хранимая часть строки u (storedRow или её копия, полученная рассылкой).
+     */
+    const W *rowWeights(const W *row_u, int u, int first, int count, W *out) const {
+        const int T = tileCount(num_vertices);
+        const int half = tilesPerRow(num_vertices) - 1;
+        const int I = u / kTile, c = u % kTile;
+        const int end = first + count;
+
+        // Полосы I..I+half по модулю T — не более двух непрерывных отрезков вершин
+        auto copy_arc = [&](int arc_begin, int arc_end, int row_offset) {
+            int lo = std::max(arc_begin, first), hi = std::min(arc_end, end);
+            if (lo < hi) std::memcpy(out + (lo - first), row_u + row_offset + (lo - arc_begin), (hi - lo) * sizeof(W));
+        };
+        copy_arc(I * kTile, std::min(I + half + 1, T) * kTile, 0);
+        if (I + half + 1 > T) copy_arc(0, (I + half + 1 - T) * kTile, (T - I) * kTile);
+
+        // Остальные полосы: столбец c плиток (J, I), w(u, v) = w(v, u)
+        for (int J = first / kTile; J <= (end - 1) / kTile; ++J) {
+            if (ringOffset(T, I, J) <= half) continue;
+            const W *column = tile(J, ringOffset(T, J, I)) + c;
+            int lo = std::max(J * kTile, first), hi = std::min(J * kTile + kTile, end);
+            for (int v = lo; v < hi; ++v) out[v - first] = column[(v - J * kTile) * kTile];
+        }
+        return out;
+    }
+};
+
+/**
+ * @brief Заполнение полос [first_tile_row, first_tile_row + num_tile_rows) упакованной матрицы.
+ * @param weight Функция W(int i, int j) — вес пары вершин (i, j < n); ячейки за n получают код отсутствия ребра.
+ */
+template <typename W, typename Weight>
+inline void packTileRows(int countVertices, int first_tile_row, int num_tile_rows, W *out, Weight &&weight) {
+    constexpr int B = PackedRowBlock<W>::kTile;
+    const int T = PackedRowBlock<W>::tileCount(countVertices);
+    const int tiles = PackedRowBlock<W>::tilesPerRow(countVertices);
+
+    for (int t = 0; t < num_tile_rows; ++t) {
+        const int I = first_tile_row + t;
+        for (int k = 0; k < tiles; ++k) {
+            const int J = (I + k) % T;
+            W *tile = out + (static_cast<std::size_t>(t) * tiles + k) * (B * B);
+            for (int r = 0; r < B; ++r) {
+                for (int c = 0; c < B; ++c) {
+                    int i = I * B + r, j = J * B + c;
+                    tile[r * B + c] = i < countVertices && j < countVertices ? weight(i, j) : WeightTraits<W>::kNoEdge;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Упаковка полос по полным строкам симметричной матрицы:
+ * rows[(i - first_tile_row * kTile) * n + j] = w(i, j).
+ */
+template <typename W>
+inline void packDenseRows(const W *rows, int countVertices, int first_tile_row, int num_tile_rows, W *out) {
+    const std::size_t first_row = static_cast<std::size_t>(first_tile_row) * PackedRowBlock<W>::kTile;
+    packTileRows(countVertices, first_tile_row, num_tile_rows, out,
+                 [&](int i, int j) { return rows[(i - first_row) * countVertices + j]; });
+}
+
+/**
+ * @brief Упакованный блок вершин [first_vertex, first_vertex + count) сгенерированного графа.
+ *
+ * Полосы генерируются порциями полных строк (generateDenseRows) и сразу упаковываются,
+ * поэтому разреженный граф строится за время, пропорциональное числу рёбер и ячеек блока.
+ * @param out Буфер PackedRowBlock<W>::blockSize(n, first_vertex, count) весов.
+ */
+template <typename W>
+inline void packGeneratedRows(const GeneratorParams &params, int countVertices, int first_vertex, int count, W *out) {
+    constexpr int B = PackedRowBlock<W>::kTile;
+    constexpr int kChunkTileRows = 16;
+    const int first_tile_row = PackedRowBlock<W>::firstTileRow(first_vertex);
+    const int num_tile_rows = PackedRowBlock<W>::numTileRows(first_vertex, count);
+
+    std::vector<W> rows;
+    for (int t = 0; t < num_tile_rows; t += kChunkTileRows) {
+        int chunk = std::min(kChunkTileRows, num_tile_rows - t);
+        int first_row = (first_tile_row + t) * B;
+        int num_rows = std::min(chunk * B, countVertices - first_row);
+        rows.resize(static_cast<std::size_t>(num_rows) * countVertices);
+        generateDenseRows(params, countVertices, first_row, num_rows, rows.data());
+        packDenseRows(rows.data(), countVertices, first_tile_row + t, chunk, out + t * PackedRowBlock<W>::tileRowSize(countVertices));
+    }
+}
+
+/**
+ * @brief Упаковка полос симметричного графа по локальному CSR строк, начиная с first_tile_row * kTile.
+ *
+ * Пустые ячейки получают код отсутствия ребра, диагональ — 0, из кратных рёбер
+ * остаётся самое лёгкое (как в densifyCsrRows).
+ */
+template <typename W>
+inline void packCsrRows(const CsrGraph &rows, int countVertices, int first_tile_row, int num_tile_rows, W *out) {
+    constexpr int B = PackedRowBlock<W>::kTile;
+    const int T = PackedRowBlock<W>::tileCount(countVertices);
+    const int half = PackedRowBlock<W>::tilesPerRow(countVertices) - 1;
+    const std::size_t row_size = PackedRowBlock<W>::tileRowSize(countVertices);
+    std::fill(out, out + num_tile_rows * row_size, WeightTraits<W>::kNoEdge);
+
+    const int first_row = first_tile_row * B;
+    for (int r = 0; r < rows.num_vertices; ++r) {
+        const int i = first_row + r;
+        const int I = i / B;
+        W *tile_row = out + (I - first_tile_row) * row_size;
+        tile_row[(i % B) * B + i % B] = 0;
+        for (int e = rows.row_offsets[r]; e < rows.row_offsets[r + 1]; ++e) {
+            const int j = rows.col_indices[e];
+            const int k = PackedRowBlock<W>::ringOffset(T, I, j / B);
+            if (k > half) continue; // пара хранится в полосе вершины j
+            W &cell = tile_row[static_cast<std::size_t>(k) * B * B + (i % B) * B + j % B];
+            W w = encodeWeight<W>(rows.weights[e]);
+            if (w < cell) cell = w;
+        }
+    }
+}
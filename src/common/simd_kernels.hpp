@@ -0,0 +1,638 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "weight_types.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SSSP_X86_SIMD 1
+#endif
+
+/**
+ * @brief Уровень набора SIMD-инструкций для ядер плотного Дейкстры.
+ */
+enum class SimdLevel { Scalar = 0, SSE4 = 1, AVX2 = 2, AVX512 = 3 };
+
+inline const char *simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE4: return "sse4";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+/**
+ * @brief Максимальный уровень, поддерживаемый текущим процессором (проверка в рантайме).
+ */
+inline SimdLevel detectSimdLevel() {
+#ifdef SSSP_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE4;
+#endif
+    return SimdLevel::Scalar;
+}
+
+/**
+ * @brief Разбор уровня из строки (--simd=auto|scalar|sse4|avx2|avx512).
+ * @return false для неизвестного значения; для "auto" — уровень процессора.
+ */
+inline bool parseSimdLevel(const std::string &name, SimdLevel &level) {
+    if (name == "auto") level = detectSimdLevel();
+    else if (name == "scalar") level = SimdLevel::Scalar;
+    else if (name == "sse4") level = SimdLevel::SSE4;
+    else if (name == "avx2") level = SimdLevel::AVX2;
+    else if (name == "avx512") level = SimdLevel::AVX512;
+    else return false;
+    return true;
+}
+
+// ============================================================================================
+// Скалярные ядра (эталон)
+//
+// Ядра работают со сжатым списком непосещённых вершин (ActiveSet): ids[k] — номер вершины,
+// dist[k] — её текущее расстояние. Посещённые вершины из списка удаляются, поэтому
+// маска посещения не нужна, а работа итерации пропорциональна числу непосещённых вершин.
+// Строка матрицы и pred индексируются номерами вершин.
+// ============================================================================================
+
+/**
+ * @brief Поиск позиции списка с минимальным расстоянием (при равенстве — меньшая позиция).
+ * @tparam D Тип расстояния (int или std::int64_t), бесконечность — distInfinity<D>().
+ * @param dist Расстояния вершин списка.
+ * @param m Длина списка.
+ * @return Позиция в списке или -1, если все вершины списка недостижимы.
+ */
+template <typename D>
+inline int argminActiveScalar(const D *dist, int m) {
+    int chosen = -1;
+    D best_dist = distInfinity<D>();
+    for (int k = 0; k < m; k++) {
+        if (dist[k] < best_dist) {
+            best_dist = dist[k];
+            chosen = k;
+        }
+    }
+    return chosen;
+}
+
+/**
+ * @brief Релаксация строки по списку: dist[k] = min(dist[k], du + row[ids[k]]), pred[ids[k]] = u.
+ *
+ * row[v] == WeightTraits<W>::kNoEdge — нет ребра; сумма с переполнением не принимается.
+ * @tparam W Тип веса (uint8_t, uint16_t или int).
+ * @tparam D Тип расстояния (int или std::int64_t).
+ * @return Число успешных релаксаций.
+ */
+template <typename W, typename D>
+inline int relaxActiveScalar(const W *row, D du, int u, const int *ids, D *dist, int *pred, int m) {
+    int updated = 0;
+    for (int k = 0; k < m; k++) {
+        W w = row[ids[k]];
+        if (w != WeightTraits<W>::kNoEdge && du <= distInfinity<D>() - static_cast<D>(w)) {
+            D new_dist = du + static_cast<D>(w);
+            if (new_dist < dist[k]) {
+                dist[k] = new_dist;
+                pred[ids[k]] = u;
+                ++updated;
+            }
+        }
+    }
+    return updated;
+}
+
+/**
+ * @brief Шаг блока пакетного режима по вершинам: число дорожек округляется до кратного 16,
+ * чтобы SIMD-ядра relaxRowBlock* проходили блок целыми векторами без хвоста.
+ */
+constexpr int kBlockLaneAlign = 16;
+
+/**
+ * @brief K-wide релаксация строки u в блок пакетного режима (min-plus ядро): для v = ids[i]
+ * dist[v * lanes + k] = min(dist[v * lanes + k], du[k] + row[v]), при улучшении pred[...] = u.
+ *
+ * Блок хранится по вершинам: расстояния вершины v от всех источников лежат подряд, поэтому
+ * вес row[v] читается один раз и релаксирует сразу все векторы. Дорожка с du[k] == INF
+ * не релаксируется (сумма насыщается до INF).
+ * @param ids, m Вершины строки, которые ещё могут улучшиться (длина списка m).
+ * @param count Число релаксируемых дорожек с начала du, dist и pred (кратно kBlockLaneAlign).
+ * @param lanes Шаг блока по вершинам (кратен kBlockLaneAlign).
+ */
+template <typename W>
+inline void relaxRowBlockScalar(const W *row, const int *ids, int m, const int *du, int u, int *dist, int *pred, int count, int lanes) {
+    for (int i = 0; i < m; i++) {
+        const int v = ids[i];
+        if (row[v] == WeightTraits<W>::kNoEdge) continue;
+        const unsigned w = static_cast<unsigned>(decodeWeight(row[v]));
+        int *dist_v = dist + static_cast<std::size_t>(v) * lanes;
+        int *pred_v = pred + static_cast<std::size_t>(v) * lanes;
+        for (int k = 0; k < count; k++) {
+            unsigned sum = static_cast<unsigned>(du[k]) + w;
+            int candidate = sum > static_cast<unsigned>(INF) ? INF : static_cast<int>(sum);
+            if (candidate < dist_v[k]) {
+                dist_v[k] = candidate;
+                pred_v[k] = u;
+            }
+        }
+    }
+}
+
+#ifdef SSSP_X86_SIMD
+// ============================================================================================
+// SIMD-ядра (только для расстояний int). Сложение насыщающее: du, w <= INF, поэтому сумма
+// точна как unsigned (< 2^32), а min_epu32(sum, INF) заменяет проверку переполнения и
+// отсутствия ребра (INF + w >= INF). Расстояния списка непрерывны и обновляются через blend
+// по маске cand < dist; веса строки собираются по ids (gather), pred — точечная запись.
+// Узкие веса (uint8/uint16) расширяются до int32, их код отсутствия ребра превращается в INF.
+// ============================================================================================
+
+// Узкий вес row[id] читается gather-ом 32-битного слова, выровненного вниз, и сдвигом:
+// выровненное слово не пересекает границу страницы, поэтому чтение за концом матрицы невозможно
+template <typename W>
+inline const int *alignedWordBase(const W *row, int &byte_offset) {
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(row);
+    byte_offset = static_cast<int>(address & 3);
+    return reinterpret_cast<const int *>(address - byte_offset);
+}
+
+template <typename W>
+__attribute__((target("sse4.1")))
+inline __m128i gatherWeightsSse4(const W *row, const int *ids) {
+    // Инструкции gather в SSE4 нет: веса собираются поэлементно
+    return _mm_setr_epi32(decodeWeight(row[ids[0]]), decodeWeight(row[ids[1]]), decodeWeight(row[ids[2]]), decodeWeight(row[ids[3]]));
+}
+
+template <typename W>
+__attribute__((target("avx2")))
+inline __m256i gatherWeightsAvx2(const W *row, const int *ids) {
+    __m256i vid = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ids));
+    if constexpr (std::is_same<W, int>::value) {
+        return _mm256_i32gather_epi32(row, vid, 4);
+    } else {
+        int byte_offset;
+        const int *base = alignedWordBase(row, byte_offset);
+        __m256i bytes = _mm256_add_epi32(_mm256_slli_epi32(vid, sizeof(W) == 1 ? 0 : 1), _mm256_set1_epi32(byte_offset));
+        __m256i words = _mm256_i32gather_epi32(base, _mm256_srli_epi32(bytes, 2), 4);
+        __m256i shift = _mm256_slli_epi32(_mm256_and_si256(bytes, _mm256_set1_epi32(3)), 3);
+        __m256i w = _mm256_and_si256(_mm256_srlv_epi32(words, shift), _mm256_set1_epi32(WeightTraits<W>::kNoEdge));
+        // INF = 0x7FFFFFFF покрывает биты кода отсутствия ребра, поэтому OR даёт ровно INF
+        __m256i missing = _mm256_cmpeq_epi32(w, _mm256_set1_epi32(WeightTraits<W>::kNoEdge));
+        return _mm256_or_si256(w, _mm256_and_si256(missing, _mm256_set1_epi32(INF)));
+    }
+}
+
+template <typename W>
+__attribute__((target("avx512f")))
+inline __m512i gatherWeightsAvx512(const W *row, const int *ids) {
+    // Маскированные формы с полной маской: обычные gather и сдвиги в GCC 12 дают ложное -Wmaybe-uninitialized
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i vid = _mm512_loadu_si512(ids);
+    if constexpr (std::is_same<W, int>::value) {
+        return _mm512_mask_i32gather_epi32(zero, 0xFFFF, vid, row, 4);
+    } else {
+        int byte_offset;
+        const int *base = alignedWordBase(row, byte_offset);
+        __m512i bytes = _mm512_add_epi32(_mm512_maskz_slli_epi32(0xFFFF, vid, sizeof(W) == 1 ? 0 : 1), _mm512_set1_epi32(byte_offset));
+        __m512i words = _mm512_mask_i32gather_epi32(zero, 0xFFFF, _mm512_maskz_srli_epi32(0xFFFF, bytes, 2), base, 4);
+        __m512i shift = _mm512_maskz_slli_epi32(0xFFFF, _mm512_and_si512(bytes, _mm512_set1_epi32(3)), 3);
+        __m512i w = _mm512_and_si512(_mm512_maskz_srlv_epi32(0xFFFF, words, shift), _mm512_set1_epi32(WeightTraits<W>::kNoEdge));
+        __mmask16 missing = _mm512_cmpeq_epi32_mask(w, _mm512_set1_epi32(WeightTraits<W>::kNoEdge));
+        return _mm512_mask_mov_epi32(w, missing, _mm512_set1_epi32(INF));
+    }
+}
+
+// Выбор минимума среди lane-кандидатов с наименьшей позицией при равенстве
+inline int reduceArgminLanes(const int *lane_dist, const int *lane_idx, int lanes, int &best_dist) {
+    int chosen = -1;
+    best_dist = INF;
+    for (int l = 0; l < lanes; ++l) {
+        if (lane_idx[l] == -1) continue;
+        if (lane_dist[l] < best_dist || (lane_dist[l] == best_dist && lane_idx[l] < chosen)) {
+            best_dist = lane_dist[l];
+            chosen = lane_idx[l];
+        }
+    }
+    return chosen;
+}
+
+// Хвост списка: позиции хвоста больше векторных, поэтому строгое сравнение сохраняет первый минимум
+inline int argminTail(const int *dist, int begin, int m, int chosen, int best_dist) {
+    for (int k = begin; k < m; k++) {
+        if (dist[k] < best_dist) {
+            best_dist = dist[k];
+            chosen = k;
+        }
+    }
+    return chosen;
+}
+
+// pred[ids[k]] = u для позиций, отмеченных битами mask (в SSE4/AVX2 нет scatter)
+inline void scatterPred(int *pred, const int *ids, int u, unsigned mask) {
+    while (mask) {
+        pred[ids[__builtin_ctz(mask)]] = u;
+        mask &= mask - 1;
+    }
+}
+
+__attribute__((target("sse4.1")))
+inline int argminActiveSse4(const int *dist, int m) {
+    __m128i vmin = _mm_set1_epi32(INF), vidx = _mm_set1_epi32(-1);
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3), step = _mm_set1_epi32(4);
+    int k = 0;
+    for (; k + 4 <= m; k += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dist + k));
+        __m128i take = _mm_cmpgt_epi32(vmin, d);
+        vmin = _mm_blendv_epi8(vmin, d, take);
+        vidx = _mm_blendv_epi8(vidx, idx, take);
+        idx = _mm_add_epi32(idx, step);
+    }
+    alignas(16) int lane_dist[4], lane_idx[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lane_dist), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lane_idx), vidx);
+    int best_dist;
+    int chosen = reduceArgminLanes(lane_dist, lane_idx, 4, best_dist);
+    return argminTail(dist, k, m, chosen, best_dist);
+}
+
+template <typename W>
+__attribute__((target("sse4.1,popcnt")))
+inline int relaxActiveSse4(const W *row, int du, int u, const int *ids, int *dist, int *pred, int m) {
+    const __m128i vdu = _mm_set1_epi32(du), vinf = _mm_set1_epi32(INF);
+    int updated = 0;
+    int k = 0;
+    for (; k + 4 <= m; k += 4) {
+        __m128i w = gatherWeightsSse4(row, ids + k);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dist + k));
+
+        __m128i cand = _mm_min_epu32(_mm_add_epi32(vdu, w), vinf);
+        __m128i better = _mm_cmpgt_epi32(d, cand);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(better)));
+        if (!mask) continue;
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dist + k), _mm_blendv_epi8(d, cand, better));
+        scatterPred(pred, ids + k, u, mask);
+        updated += __builtin_popcount(mask);
+    }
+    return updated + relaxActiveScalar(row, du, u, ids + k, dist + k, pred, m - k);
+}
+
+__attribute__((target("avx2")))
+inline int argminActiveAvx2(const int *dist, int m) {
+    __m256i vmin = _mm256_set1_epi32(INF), vidx = _mm256_set1_epi32(-1);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), step = _mm256_set1_epi32(8);
+    int k = 0;
+    for (; k + 8 <= m; k += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dist + k));
+        __m256i take = _mm256_cmpgt_epi32(vmin, d);
+        vmin = _mm256_blendv_epi8(vmin, d, take);
+        vidx = _mm256_blendv_epi8(vidx, idx, take);
+        idx = _mm256_add_epi32(idx, step);
+    }
+    alignas(32) int lane_dist[8], lane_idx[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lane_dist), vmin);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lane_idx), vidx);
+    int best_dist;
+    int chosen = reduceArgminLanes(lane_dist, lane_idx, 8, best_dist);
+    return argminTail(dist, k, m, chosen, best_dist);
+}
+
+template <typename W>
+__attribute__((target("avx2,popcnt")))
+inline int relaxActiveAvx2(const W *row, int du, int u, const int *ids, int *dist, int *pred, int m) {
+    const __m256i vdu = _mm256_set1_epi32(du), vinf = _mm256_set1_epi32(INF);
+    int updated = 0;
+    int k = 0;
+    for (; k + 8 <= m; k += 8) {
+        __m256i w = gatherWeightsAvx2(row, ids + k);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dist + k));
+
+        __m256i cand = _mm256_min_epu32(_mm256_add_epi32(vdu, w), vinf);
+        __m256i better = _mm256_cmpgt_epi32(d, cand);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(better)));
+        if (!mask) continue;
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dist + k), _mm256_blendv_epi8(d, cand, better));
+        scatterPred(pred, ids + k, u, mask);
+        updated += __builtin_popcount(mask);
+    }
+    return updated + relaxActiveScalar(row, du, u, ids + k, dist + k, pred, m - k);
+}
+
+__attribute__((target("avx512f")))
+inline int argminActiveAvx512(const int *dist, int m) {
+    __m512i vmin = _mm512_set1_epi32(INF), vidx = _mm512_set1_epi32(-1);
+    __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step = _mm512_set1_epi32(16);
+    int k = 0;
+    for (; k + 16 <= m; k += 16) {
+        __m512i d = _mm512_loadu_si512(dist + k);
+        __mmask16 take = _mm512_cmpgt_epi32_mask(vmin, d);
+        vmin = _mm512_mask_blend_epi32(take, vmin, d);
+        vidx = _mm512_mask_blend_epi32(take, vidx, idx);
+        idx = _mm512_add_epi32(idx, step);
+    }
+    alignas(64) int lane_dist[16], lane_idx[16];
+    _mm512_store_si512(lane_dist, vmin);
+    _mm512_store_si512(lane_idx, vidx);
+    int best_dist;
+    int chosen = reduceArgminLanes(lane_dist, lane_idx, 16, best_dist);
+    return argminTail(dist, k, m, chosen, best_dist);
+}
+
+template <typename W>
+__attribute__((target("avx512f,popcnt")))
+inline int relaxActiveAvx512(const W *row, int du, int u, const int *ids, int *dist, int *pred, int m) {
+    const __m512i vdu = _mm512_set1_epi32(du), vu = _mm512_set1_epi32(u), vinf = _mm512_set1_epi32(INF);
+    int updated = 0;
+    int k = 0;
+    for (; k + 16 <= m; k += 16) {
+        __m512i w = gatherWeightsAvx512(row, ids + k);
+        __m512i d = _mm512_loadu_si512(dist + k);
+
+        // Маскированная форма с полной маской: _mm512_min_epu32 в GCC 12 даёт ложное -Wmaybe-uninitialized
+        __m512i cand = _mm512_mask_min_epu32(vinf, 0xFFFF, _mm512_add_epi32(vdu, w), vinf);
+        __mmask16 better = _mm512_cmpgt_epi32_mask(d, cand);
+        if (!better) continue;
+
+        _mm512_mask_storeu_epi32(dist + k, better, cand);
+        _mm512_mask_i32scatter_epi32(pred, better, _mm512_loadu_si512(ids + k), vu, 4);
+        updated += __builtin_popcount(better);
+    }
+    return updated + relaxActiveScalar(row, du, u, ids + k, dist + k, pred, m - k);
+}
+template <typename W>
+__attribute__((target("sse4.1")))
+inline void relaxRowBlockSse4(const W *row, const int *ids, int m, const int *du, int u, int *dist, int *pred, int count, int lanes) {
+    const __m128i vu = _mm_set1_epi32(u), vinf = _mm_set1_epi32(INF);
+    for (int i = 0; i < m; i++) {
+        const int v = ids[i];
+        if (row[v] == WeightTraits<W>::kNoEdge) continue;
+        const __m128i vw = _mm_set1_epi32(decodeWeight(row[v]));
+        int *dist_v = dist + static_cast<std::size_t>(v) * lanes;
+        int *pred_v = pred + static_cast<std::size_t>(v) * lanes;
+        for (int k = 0; k < count; k += 4) {
+            __m128i cand = _mm_min_epu32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(du + k)), vw), vinf);
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dist_v + k));
+            __m128i better = _mm_cmpgt_epi32(d, cand);
+            if (_mm_testz_si128(better, better)) continue;
+
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pred_v + k));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dist_v + k), _mm_blendv_epi8(d, cand, better));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pred_v + k), _mm_blendv_epi8(p, vu, better));
+        }
+    }
+}
+
+template <typename W>
+__attribute__((target("avx2")))
+inline void relaxRowBlockAvx2(const W *row, const int *ids, int m, const int *du, int u, int *dist, int *pred, int count, int lanes) {
+    const __m256i vu = _mm256_set1_epi32(u), vinf = _mm256_set1_epi32(INF);
+    for (int i = 0; i < m; i++) {
+        const int v = ids[i];
+        if (row[v] == WeightTraits<W>::kNoEdge) continue;
+        const __m256i vw = _mm256_set1_epi32(decodeWeight(row[v]));
+        int *dist_v = dist + static_cast<std::size_t>(v) * lanes;
+        int *pred_v = pred + static_cast<std::size_t>(v) * lanes;
+        for (int k = 0; k < count; k += 8) {
+            __m256i cand = _mm256_min_epu32(_mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(du + k)), vw), vinf);
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dist_v + k));
+            __m256i better = _mm256_cmpgt_epi32(d, cand);
+            if (_mm256_testz_si256(better, better)) continue;
+
+            __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pred_v + k));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dist_v + k), _mm256_blendv_epi8(d, cand, better));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(pred_v + k), _mm256_blendv_epi8(p, vu, better));
+        }
+    }
+}
+
+template <typename W>
+__attribute__((target("avx512f")))
+inline void relaxRowBlockAvx512(const W *row, const int *ids, int m, const int *du, int u, int *dist, int *pred, int count, int lanes) {
+    const __m512i vu = _mm512_set1_epi32(u), vinf = _mm512_set1_epi32(INF);
+    for (int i = 0; i < m; i++) {
+        const int v = ids[i];
+        if (row[v] == WeightTraits<W>::kNoEdge) continue;
+        const __m512i vw = _mm512_set1_epi32(decodeWeight(row[v]));
+        int *dist_v = dist + static_cast<std::size_t>(v) * lanes;
+        int *pred_v = pred + static_cast<std::size_t>(v) * lanes;
+        for (int k = 0; k < count; k += 16) {
+            __m512i cand = _mm512_mask_min_epu32(vinf, 0xFFFF, _mm512_add_epi32(_mm512_loadu_si512(du + k), vw), vinf);
+            __mmask16 better = _mm512_cmpgt_epi32_mask(_mm512_loadu_si512(dist_v + k), cand);
+            if (!better) continue;
+
+            _mm512_mask_storeu_epi32(dist_v + k, better, cand);
+            _mm512_mask_storeu_epi32(pred_v + k, better, vu);
+        }
+    }
+}
+#endif // SSSP_X86_SIMD
+
+// ============================================================================================
+// Диспетчеризация
+// ============================================================================================
+
+/**
+ * @brief Набор ядер, выбранный для уровня SIMD.
+ * @tparam W Тип веса строки матрицы, D — тип расстояния.
+ */
+template <typename W = int, typename D = int>
+struct SimdKernels {
+    SimdLevel level;
+    int (*argmin_active)(const D *dist, int m);
+    int (*relax_active)(const W *row, D du, int u, const int *ids, D *dist, int *pred, int m);
+};
+
+/**
+ * @brief Ядра для запрошенного уровня; уровень понижается до поддерживаемого процессором.
+ *
+ * SIMD-ядра есть только для расстояний int; для std::int64_t выбираются скалярные.
+ */
+template <typename W = int, typename D = int>
+inline SimdKernels<W, D> selectSimdKernels(SimdLevel requested) {
+    if constexpr (std::is_same<D, int>::value) {
+        SimdLevel supported = detectSimdLevel();
+        SimdLevel level = static_cast<int>(requested) > static_cast<int>(supported) ? supported : requested;
+
+#ifdef SSSP_X86_SIMD
+        switch (level) {
+            case SimdLevel::AVX512: return {level, argminActiveAvx512, relaxActiveAvx512<W>};
+            case SimdLevel::AVX2: return {level, argminActiveAvx2, relaxActiveAvx2<W>};
+            case SimdLevel::SSE4: return {level, argminActiveSse4, relaxActiveSse4<W>};
+            default: break;
+        }
+#endif
+    }
+    return {SimdLevel::Scalar, argminActiveScalar<D>, relaxActiveScalar<W, D>};
+}
+
+/**
+ * @brief K-wide ядро пакетного режима (relaxRowBlock*) для запрошенного уровня SIMD.
+ */
+template <typename W>
+using RowBlockKernel = void (*)(const W *row, const int *ids, int m, const int *du, int u, int *dist, int *pred, int count, int lanes);
+
+template <typename W>
+inline RowBlockKernel<W> selectRowBlockKernel(SimdLevel requested) {
+    SimdLevel supported = detectSimdLevel();
+    SimdLevel level = static_cast<int>(requested) > static_cast<int>(supported) ? supported : requested;
+
+#ifdef SSSP_X86_SIMD
+    switch (level) {
+        case SimdLevel::AVX512: return relaxRowBlockAvx512<W>;
+        case SimdLevel::AVX2: return relaxRowBlockAvx2<W>;
+        case SimdLevel::SSE4: return relaxRowBlockSse4<W>;
+        default: break;
+    }
+#endif
+    return relaxRowBlockScalar<W>;
+}
+
+/**
+ * @brief Проверка ядер релаксации для типа веса W против скалярного эталона.
+ * @return Число несовпадений; cases увеличивается на число проверенных случаев.
+ */
+template <typename W>
+inline int simdSelfTestRelax(SimdLevel level, std::mt19937 &rng, int &cases) {
+    SimdKernels<W> kernels = selectSimdKernels<W>(level);
+    const int near_max = WeightTraits<W>::kMaxWeight;
+    int failures = 0;
+
+    for (int n : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 100, 1000}) {
+        for (int trial = 0; trial < 50; ++trial, ++cases) {
+            // Строка длиннее списка; ids — перемешанные номера, хвостовая вершина строки
+            // (id = длина - 1) проверяет чтение узкого веса у самого конца матрицы
+            const int row_length = n + static_cast<int>(rng() % 8);
+            std::vector<int> ids(row_length);
+            for (int v = 0; v < row_length; ++v) ids[v] = v;
+            std::shuffle(ids.begin(), ids.end(), rng);
+            if (n > 0) std::swap(*std::find(ids.begin(), ids.end(), row_length - 1), ids[rng() % n]);
+            ids.resize(n);
+            std::vector<int> dist(n);
+            std::vector<W> row(row_length);
+            for (int v = 0; v < row_length; ++v) {
+                int kind = static_cast<int>(rng() % 10);
+                row[v] = kind == 1 ? WeightTraits<W>::kNoEdge
+                       : static_cast<W>(kind == 2 ? near_max - static_cast<int>(rng() % 10) : static_cast<int>(rng() % 100));
+            }
+            for (int k = 0; k < n; ++k) dist[k] = rng() % 10 == 0 ? INF : static_cast<int>(rng() % 50); // много равных значений
+            int du = (trial % 5 == 0) ? INF - 5 : static_cast<int>(rng() % 100);
+
+            // Смещение строки от выровненного адреса проверяет сборку узких весов из 32-битных слов
+            const W *row_data = row.data();
+            std::vector<W> shifted(row_length + 3);
+            if (trial % 2 == 1) {
+                std::copy(row.begin(), row.end(), shifted.begin() + 1);
+                row_data = shifted.data() + 1;
+            }
+
+            std::vector<int> dist_ref = dist, pred_ref(row_length, -1), dist_simd = dist, pred_simd(row_length, -1);
+            int updated_ref = relaxActiveScalar(row_data, du, 7, ids.data(), dist_ref.data(), pred_ref.data(), n);
+            int updated_simd = kernels.relax_active(row_data, du, 7, ids.data(), dist_simd.data(), pred_simd.data(), n);
+            if (updated_ref != updated_simd || dist_ref != dist_simd || pred_ref != pred_simd) {
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Проверка K-wide ядра пакетного режима для типа веса W против скалярного эталона.
+ * @return Число несовпадений; cases увеличивается на число проверенных случаев.
+ */
+template <typename W>
+inline int simdSelfTestRowBlock(SimdLevel level, std::mt19937 &rng, int &cases) {
+    RowBlockKernel<W> kernel = selectRowBlockKernel<W>(level);
+    const int near_max = WeightTraits<W>::kMaxWeight;
+    int failures = 0;
+
+    for (int m : {0, 1, 7, 64, 300}) {
+        for (int lanes = kBlockLaneAlign; lanes <= 3 * kBlockLaneAlign; lanes += kBlockLaneAlign) {
+            for (int trial = 0; trial < 20; ++trial, ++cases) {
+                std::vector<W> row(m);
+                for (int v = 0; v < m; ++v) {
+                    int kind = static_cast<int>(rng() % 10);
+                    row[v] = kind == 1 ? WeightTraits<W>::kNoEdge
+                           : static_cast<W>(kind == 2 ? near_max - static_cast<int>(rng() % 10) : static_cast<int>(rng() % 100));
+                }
+                // Перемешанное подмножество вершин строки
+                std::vector<int> ids(m);
+                for (int v = 0; v < m; ++v) ids[v] = v;
+                std::shuffle(ids.begin(), ids.end(), rng);
+                const int num_ids = m == 0 ? 0 : static_cast<int>(rng() % (m + 1));
+
+                // INF и INF - 5 в du проверяют насыщение суммы
+                std::vector<int> du(lanes), dist(static_cast<std::size_t>(m) * lanes);
+                for (int k = 0; k < lanes; ++k) {
+                    int kind = static_cast<int>(rng() % 10);
+                    du[k] = kind == 0 ? INF : kind == 1 ? INF - 5 : static_cast<int>(rng() % 100);
+                }
+                for (int &d : dist) d = rng() % 10 == 0 ? INF : static_cast<int>(rng() % 150);
+
+                // Релаксируется только часть дорожек: остальные должны остаться нетронутыми
+                const int count = kBlockLaneAlign * (1 + trial % (lanes / kBlockLaneAlign));
+                std::vector<int> dist_ref = dist, pred_ref(dist.size(), -1), dist_simd = dist, pred_simd(dist.size(), -1);
+                relaxRowBlockScalar(row.data(), ids.data(), num_ids, du.data(), 7, dist_ref.data(), pred_ref.data(), count, lanes);
+                kernel(row.data(), ids.data(), num_ids, du.data(), 7, dist_simd.data(), pred_simd.data(), count, lanes);
+                if (dist_ref != dist_simd || pred_ref != pred_simd) {
+                    ++failures;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Самопроверка: каждое доступное ядро сравнивается со скалярным на случайных данных.
+ *
+ * Покрываются разные длины (в том числе хвосты короче вектора), INF в расстояниях,
+ * отсутствующие рёбра и веса около максимума для всех типов веса (переполнение),
+ * равные минимумы, перемешанные списки вершин и невыровненные строки узких весов,
+ * а также K-wide ядро пакетного режима.
+ * @return true, если все ядра совпали со скалярными.
+ */
+inline bool simdSelfTest() {
+    std::mt19937 rng(12345);
+    bool all_ok = true;
+
+    for (int lvl = static_cast<int>(SimdLevel::SSE4); lvl <= static_cast<int>(detectSimdLevel()); ++lvl) {
+        SimdLevel level = static_cast<SimdLevel>(lvl);
+        SimdKernels<> kernels = selectSimdKernels(level);
+        int failures = 0, cases = 0;
+
+        for (int n : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 100, 1000}) {
+            for (int trial = 0; trial < 50; ++trial, ++cases) {
+                std::vector<int> dist(n);
+                for (int k = 0; k < n; ++k) {
+                    dist[k] = (rng() % 10 == 0) ? INF : static_cast<int>(rng() % 50);
+                }
+                if (kernels.argmin_active(dist.data(), n) != argminActiveScalar(dist.data(), n)) {
+                    ++failures;
+                }
+            }
+        }
+
+        failures += simdSelfTestRelax<int>(level, rng, cases);
+        failures += simdSelfTestRelax<std::uint16_t>(level, rng, cases);
+        failures += simdSelfTestRelax<std::uint8_t>(level, rng, cases);
+        failures += simdSelfTestRowBlock<int>(level, rng, cases);
+        failures += simdSelfTestRowBlock<std::uint16_t>(level, rng, cases);
+        failures += simdSelfTestRowBlock<std::uint8_t>(level, rng, cases);
+
+        std::printf("SIMD self-test %-7s: %s (%d cases, %d failures)\n", simdLevelName(kernels.level), failures == 0 ? "OK" : "FAIL", cases, failures);
+        all_ok = all_ok && failures == 0;
+    }
+
+    return all_ok;
+}
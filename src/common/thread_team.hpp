@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Многоразовый барьер для фиксированного числа потоков (mutex + condition_variable).
+ */
+class ThreadBarrier {
+public:
+    explicit ThreadBarrier(int count) : count_(count), waiting_(0), generation_(0) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        unsigned long generation = generation_;
+        if (++waiting_ == count_) {
+            waiting_ = 0;
+            ++generation_;
+            cv_.notify_all();
+            return;
+        }
+        cv_.wait(lock, [&] { return generation != generation_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_;
+    int waiting_;
+    unsigned long generation_;
+};
+
+/**
+ * @brief Многоразовый барьер на атомиках с активным ожиданием.
+ *
+ * Для коротких фаз (две синхронизации на итерацию Дейкстры) засыпание на
+ * condition_variable дороже самой работы. После kSpinLimit проверок поток
+ * уступает процессор (yield), чтобы не мешать при переподписке ядер.
+ */
+class SpinBarrier {
+public:
+    explicit SpinBarrier(int count) : count_(count), waiting_(0), generation_(0) {}
+
+    void wait() {
+        unsigned generation = generation_.load(std::memory_order_acquire);
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+            waiting_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        for (int spins = 0; generation_.load(std::memory_order_acquire) == generation; ++spins) {
+            if (spins >= kSpinLimit) std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr int kSpinLimit = 4096;
+    const int count_;
+    alignas(64) std::atomic<int> waiting_;
+    alignas(64) std::atomic<unsigned> generation_;
+};
+
+/**
+ * @brief Запуск body(thread_id) на num_threads потоках: поток 0 — вызывающий, остальные создаются
+ * один раз на весь вызов (постоянная команда потоков, синхронизация — барьерами внутри body).
+ *
+ * Поток 0 остаётся тем потоком, который инициализировал MPI, поэтому только он может
+ * вызывать MPI (уровень MPI_THREAD_FUNNELED).
+ */
+template <typename Body>
+void runThreadTeam(int num_threads, Body &&body) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(body, t);
+    }
+    body(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Локальный минимум потока {расстояние, индекс}, выровненный по кэш-линии (без false sharing).
+ * @tparam D Тип расстояния (int или std::int64_t).
+ */
+template <typename D = int>
+struct alignas(64) ThreadArgmin {
+    D dist = std::numeric_limits<D>::max();
+    int index = -1;
+};
+
+/**
+ * @brief Минимум по потокам; при равных расстояниях — меньший индекс (как у MPI_MINLOC).
+ */
+template <typename D>
+inline ThreadArgmin<D> reduceThreadArgmin(const std::vector<ThreadArgmin<D>> &minima) {
+    ThreadArgmin<D> best;
+    for (const ThreadArgmin<D> &m : minima) {
+        if (m.index == -1) continue;
+        if (best.index == -1 || m.dist < best.dist || (m.dist == best.dist && m.index < best.index)) best = m;
+    }
+    return best;
+}
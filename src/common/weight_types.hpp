@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/**
+ * Типы весов плотной матрицы: uint8_t, uint16_t или int (int32).
+ *
+ * Отсутствие ребра кодируется максимальным значением типа (0xFF, 0xFFFF, INT32_MAX = INF) —
+ * так же, как в бинарном файле графа, поэтому полезная нагрузка файла любой ширины
+ * используется как матрица без преобразования. Расстояния — int или std::int64_t,
+ * бесконечность — максимальное значение типа расстояния.
+ */
+template <typename W>
+struct WeightTraits {
+    static_assert(std::is_same<W, std::uint8_t>::value || std::is_same<W, std::uint16_t>::value || std::is_same<W, int>::value,
+                  "weight type must be uint8_t, uint16_t or int");
+    static constexpr W kNoEdge = std::numeric_limits<W>::max();
+    static constexpr int kMaxWeight = static_cast<int>(kNoEdge) - 1; // наибольший допустимый вес
+};
+
+template <typename W>
+inline const char *weightTypeName() {
+    if (std::is_same<W, std::uint8_t>::value) return "uint8";
+    if (std::is_same<W, std::uint16_t>::value) return "uint16";
+    return "int32";
+}
+
+template <typename D>
+constexpr D distInfinity() { return std::numeric_limits<D>::max(); }
+
+/**
+ * @brief Помещается ли любой простой путь в 32-битное расстояние: (n - 1) * max_weight < INF.
+ *
+ * Ядра с расстояниями int насыщаются на INF, поэтому более длинный путь не переполняется,
+ * а молча превращается в «недостижимо»; такие запуски требуют 64-битных расстояний.
+ */
+inline bool fitsIntDistances(int countVertices, int max_weight) {
+    return static_cast<long long>(countVertices - 1) * max_weight < std::numeric_limits<int>::max();
+}
+
+/**
+ * @brief Вес ребра в int: код отсутствия ребра становится INF (INT_MAX).
+ */
+template <typename W>
+inline int decodeWeight(W w) {
+    return w == WeightTraits<W>::kNoEdge ? std::numeric_limits<int>::max() : static_cast<int>(w);
+}
+
+/**
+ * @brief Наибольший вес среди count ячеек плотного блока (0, если рёбер нет).
+ */
+template <typename W>
+inline int maxStoredWeight(const W *cells, std::size_t count) {
+    W max_weight = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (cells[i] != WeightTraits<W>::kNoEdge && cells[i] > max_weight) max_weight = cells[i];
+    }
+    return static_cast<int>(max_weight);
+}
+
+/**
+ * @brief Вес int (INF = INT_MAX — нет ребра) в представлении типа W.
+ */
+template <typename W>
+inline W encodeWeight(int w) {
+    return w == std::numeric_limits<int>::max() ? WeightTraits<W>::kNoEdge : static_cast<W>(w);
+}
+
+/**
+ * @brief Вызов fn(W{}) с типом веса, соответствующим ширине weight_bytes (1, 2 или 4).
+ */
+template <typename Fn>
+decltype(auto) dispatchWeightType(std::uint32_t weight_bytes, Fn &&fn) {
+    if (weight_bytes == 1) return fn(std::uint8_t{});
+    if (weight_bytes == 2) return fn(std::uint16_t{});
+    return fn(int{});
+}
+
+/**
+ * @brief Вызов fn(D{}) с типом расстояния: int для 32 бит, std::int64_t для 64.
+ */
+template <typename Fn>
+decltype(auto) dispatchDistType(int dist_bits, Fn &&fn) {
+    if (dist_bits == 64) return fn(std::int64_t{});
+    return fn(int{});
+}
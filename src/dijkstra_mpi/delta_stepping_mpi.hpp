@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "partition.hpp"
+#include "profile_mpi.hpp"
+
+namespace delta_stepping_mpi_detail {
+
+/**
+ * @brief Обмен запросами релаксации: тройки {вершина, расстояние, предок}, сгруппированные по процессам.
+ *
+ * Сначала MPI_Alltoall передаёт количества, затем MPI_Alltoallv — сами тройки.
+ * @param outgoing [in/out] Исходящие тройки по процессам-получателям; очищаются после обмена.
+ * @param incoming [out] Принятые тройки (плоский массив).
+ * @return Объём обмена процесса в байтах (отправлено + получено, вместе с количествами).
+ */
+inline std::uint64_t exchangeRequests(std::vector<std::vector<int>> &outgoing, std::vector<int> &incoming, MPI_Comm comm) {
+    int num_procs = static_cast<int>(outgoing.size());
+    std::vector<int> send_counts(num_procs), recv_counts(num_procs);
+    std::vector<int> send_displs(num_procs), recv_displs(num_procs);
+
+    for (int p = 0; p < num_procs; ++p) {
+        send_counts[p] = static_cast<int>(outgoing[p].size());
+    }
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+    int send_total = 0, recv_total = 0;
+    for (int p = 0; p < num_procs; ++p) {
+        send_displs[p] = send_total;
+        recv_displs[p] = recv_total;
+        send_total += send_counts[p];
+        recv_total += recv_counts[p];
+    }
+
+    std::vector<int> send_buffer(send_total);
+    for (int p = 0; p < num_procs; ++p) {
+        std::copy(outgoing[p].begin(), outgoing[p].end(), send_buffer.begin() + send_displs[p]);
+        outgoing[p].clear();
+    }
+
+    incoming.resize(recv_total);
+    MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_INT,
+                  incoming.data(), recv_counts.data(), recv_displs.data(), MPI_INT, comm);
+    return (2ULL * num_procs + send_total + recv_total) * sizeof(int);
+}
+
+} // namespace delta_stepping_mpi_detail
+
+/**
+ * @brief Распределённый delta-stepping: вершины разбиты блоками по процессам, рёбра — в локальном CSR.
+ *
+ * За раунд обрабатывается целая корзина: каждый процесс релаксирует рёбра своих вершин
+ * из корзины и копит запросы для владельцев концов рёбер, после чего все запросы
+ * фазы передаются одним MPI_Alltoallv. Лёгкие рёбра (w <= delta) обрабатываются
+ * фазами до опустошения корзины, тяжёлые — один раз после неё.
+ * Число коллективных шагов пропорционально числу фаз, а не числу вершин.
+ *
+ * @param local_graph CSR исходящих рёбер своих вершин (локальные строки, глобальные столбцы).
+ * @param local_dist [out] Массив локальных расстояний (размер = partition.size(rank)).
+ * @param local_pred [out] Массив предков (размер = partition.size(rank)).
+ * @param partition Разбиение вершин по процессам (блоки могут быть неравными).
+ * @param start Начальная вершина (глобальный индекс).
+ * @param target Целевая вершина (-1 — все вершины): поиск завершается после лёгких фаз корзины
+ *               с её расстоянием; признак готовности владелец передаёт в той же редукции флага работы.
+ * @param delta Ширина корзины (>= 1).
+ * @param comm MPI-коммуникатор.
+ * @param profile [out] Профиль запуска (nullptr — без профилирования); iterations — число корзин,
+ *                попытки релаксации — принятые запросы.
+ * @return Число обработанных вершин всех процессов (одинаково на всех процессах).
+ */
+inline int dijkstra_mpi_delta(const CsrGraph &local_graph, int *local_dist, int *local_pred, const BlockPartition &partition, int start, int target, int delta, MPI_Comm comm, RunProfile *profile = nullptr) {
+    using namespace delta_stepping_mpi_detail;
+
+    int rank = 0, num_procs = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_procs);
+
+    const int my_block_begin = partition.begin(rank);
+    const int rows_per_proc = partition.size(rank);
+    if (delta < 1) delta = 1;
+
+    int local_max_weight = local_graph.maxWeight(), max_weight = 0;
+    MPI_Allreduce(&local_max_weight, &max_weight, 1, MPI_INT, MPI_MAX, comm);
+
+    // Циклический массив корзин с локальными индексами вершин
+    const std::size_t num_buckets = static_cast<std::size_t>(max_weight / delta) + 2;
+    std::vector<std::vector<int>> buckets(num_buckets);
+    std::vector<int> processed_dist(rows_per_proc, INF);
+    std::vector<long long> settled_bucket(rows_per_proc, -1);
+    std::vector<int> settled, frontier, incoming;
+    std::vector<std::vector<int>> outgoing(num_procs);
+
+    for (int i = 0; i < rows_per_proc; ++i) {
+        local_dist[i] = INF;
+        local_pred[i] = -1;
+    }
+    if (start >= my_block_begin && start < my_block_begin + rows_per_proc) {
+        local_dist[start - my_block_begin] = 0;
+        buckets[0].push_back(start - my_block_begin);
+    }
+
+    // Формирует запросы по рёбрам вершины u: лёгким (heavy = false) или тяжёлым
+    auto generate = [&](int local_u, bool heavy) {
+        int d = local_dist[local_u];
+        for (int e = local_graph.row_offsets[local_u]; e < local_graph.row_offsets[local_u + 1]; ++e) {
+            int w = local_graph.weights[e];
+            if ((w > delta) != heavy || d > INF - w) continue;
+
+            int v = local_graph.col_indices[e];
+            std::vector<int> &out = outgoing[partition.owner(v)];
+            out.push_back(v);
+            out.push_back(d + w);
+            out.push_back(my_block_begin + local_u);
+        }
+    };
+
+    // Применяет принятые запросы к своим вершинам
+    std::uint64_t attempted = 0, successful = 0;
+    auto apply = [&]() {
+        PhaseTimer timer(profile, kPhaseRelax);
+        attempted += incoming.size() / 3;
+        for (std::size_t k = 0; k + 2 < incoming.size(); k += 3) {
+            int local_v = incoming[k] - my_block_begin;
+            int candidate = incoming[k + 1];
+            if (candidate < local_dist[local_v]) {
+                local_dist[local_v] = candidate;
+                local_pred[local_v] = incoming[k + 2];
+                buckets[static_cast<std::size_t>(candidate / delta) % num_buckets].push_back(local_v);
+                ++successful;
+            }
+        }
+    };
+
+    // Обмен запросами; при профилировании барьер отделяет ожидание отстающих от самого обмена
+    auto exchange = [&]() {
+        profileBarrier(profile, comm);
+        PhaseTimer timer(profile, kPhaseExchange);
+        std::uint64_t bytes = exchangeRequests(outgoing, incoming, comm);
+        if (profile) profile->bytes += bytes;
+    };
+
+    const bool own_target = target >= my_block_begin && target < my_block_begin + rows_per_proc;
+    bool reached_target = false;
+    int settled_count = 0;
+    long long current = 0;
+    while (true) {
+        // 1. Глобально минимальная непустая корзина
+        long long local_next = LLONG_MAX, next = LLONG_MAX;
+        {
+            PhaseTimer timer(profile, kPhaseSelect);
+            for (std::size_t k = 0; k < num_buckets; ++k) {
+                if (!buckets[static_cast<std::size_t>(current + k) % num_buckets].empty()) {
+                    local_next = current + static_cast<long long>(k);
+                    break;
+                }
+            }
+        }
+        {
+            PhaseTimer timer(profile, kPhaseReduce);
+            MPI_Allreduce(&local_next, &next, 1, MPI_LONG_LONG, MPI_MIN, comm);
+        }
+        if (profile) profile->bytes += 2 * sizeof(next);
+        if (next == LLONG_MAX) break;
+        if (profile) ++profile->iterations;
+        current = next;
+        std::vector<int> &bucket = buckets[static_cast<std::size_t>(current) % num_buckets];
+
+        // 2. Фазы лёгких рёбер с пакетным обменом запросами
+        while (true) {
+            frontier.swap(bucket);
+            bucket.clear();
+
+            PhaseTimer relax_timer(profile, kPhaseRelax);
+            for (int local_u : frontier) {
+                int d = local_dist[local_u];
+                if (d / delta != current || processed_dist[local_u] == d) continue;
+                processed_dist[local_u] = d;
+                if (settled_bucket[local_u] != current) {
+                    settled_bucket[local_u] = current;
+                    settled.push_back(local_u);
+                }
+                generate(local_u, false);
+            }
+            frontier.clear();
+            relax_timer.stop();
+
+            exchange();
+            apply();
+
+            // Бит 1 — непустая корзина, бит 2 — расстояние цели уже в корзинах <= current
+            int local_flags = bucket.empty() ? 0 : 1, flags = 0;
+            if (own_target && local_dist[target - my_block_begin] / delta <= current) local_flags |= 2;
+            {
+                PhaseTimer timer(profile, kPhaseReduce);
+                MPI_Allreduce(&local_flags, &flags, 1, MPI_INT, MPI_BOR, comm);
+            }
+            if (profile) profile->bytes += 2 * sizeof(flags);
+            if (!(flags & 1)) {
+                reached_target = (flags & 2) != 0;
+                break;
+            }
+        }
+        settled_count += static_cast<int>(settled.size());
+
+        // После лёгких фаз расстояния корзины current окончательны, тяжёлые рёбра дают только большие
+        if (reached_target) break;
+
+        // 3. Тяжёлые рёбра всех вершин корзины — одним обменом
+        {
+            PhaseTimer timer(profile, kPhaseRelax);
+            for (int local_u : settled) {
+                generate(local_u, true);
+            }
+            settled.clear();
+        }
+
+        exchange();
+        apply();
+    }
+
+    if (profile) {
+        profile->relax_attempted += attempted;
+        profile->relax_successful += successful;
+    }
+
+    int total_settled = 0;
+    MPI_Allreduce(&settled_count, &total_settled, 1, MPI_INT, MPI_SUM, comm);
+    return total_settled;
+}
@@ -3,250 +3,1219 @@
 #include <string>
 #include <limits>
 #include <algorithm>
-#include <array>
 #include <cstring>
 #include <stdexcept>
 #include <cstdio>
 #include <mpi.h>
-constexpr int INF = std::numeric_limits<int>::max();
+#include "../common/active_set.hpp"
+#include "../common/batch_sssp.hpp"
+#include "../common/cli.hpp"
+#include "../common/graph.hpp"
+#include "../common/graph_generator.hpp"
+#include "../common/memory_placement.hpp"
+#include "../common/path.hpp"
+#include "../common/profile.hpp"
+#include "../common/query_server.hpp"
+#include "../common/row_block.hpp"
+#include "../common/simd_kernels.hpp"
+#include "../common/thread_team.hpp"
+#include "../common/weight_types.hpp"
+#include "delta_stepping_mpi.hpp"
+#include "dist_type_mpi.hpp"
+#include "dijkstra_mpi_2d.hpp"
+#include "graph_file_mpi.hpp"
+#include "partition.hpp"
+#include "profile_mpi.hpp"
+#include "reorder_mpi.hpp"
+#include "result_file_mpi.hpp"
 
 /**
- * @brief Генерация графа со случайными весами, возвращает плоский вектор n*n (row-major).
- * @param countVertices Количество вершин.
+ * @brief Параллельная реализация алгоритма Дейкстры с использованием MPI.
+ *
+ * Внутри процесса свои вершины делятся между num_threads потоками: каждый ищет минимум
+ * и релаксирует свой отрезок, а MPI вызывает только поток 0 (MPI_THREAD_FUNNELED).
+ * Поток держит сжатый список непосещённых вершин своего отрезка (ActiveSet), так что
+ * работа итерации пропорциональна числу ещё не посещённых вершин, а не rows_per_proc.
+ * Владелец рассылает хранимую часть строки: для упакованной раскладки это около n/2 весов,
+ * а недостающие веса своего отрезка каждый поток берёт из столбца u своих плиток.
+ *
+ * @tparam W Тип веса матрицы (uint8_t, uint16_t или int): узкие веса уменьшают и поток памяти, и объём рассылки строки.
+ * @tparam D Тип расстояния (int или std::int64_t при --dist-bits=64).
+ * @tparam Rows Раскладка блока строк (row_block.hpp): DenseRowBlock или PackedRowBlock.
+ * @param local_rows Свои строки матрицы смежности (строчно разбита по процессам).
+ * @param loc_dist_ptr Указатель на массив локальных расстояний (размер = partition.size(rank)).
+ * @param loc_pred_ptr Указатель на массив предков (размер = partition.size(rank)).
+ * @param partition Разбиение вершин по процессам (блоки могут отличаться на одну строку).
+ * @param start Начальная вершина (глобальный индекс).
+ * @param target Целевая вершина: цикл завершается, как только MINLOC выбирает её (-1 — все вершины).
+ * @param comm MPI-коммуникатор.
+ * @param kernels Ядра поиска минимума и релаксации (selectSimdKernels).
+ * @param num_threads Число потоков внутри процесса.
+ * @param profile [out] Профиль запуска (nullptr — без профилирования); фазы замеряет поток 0.
+ * @return Число посещённых вершин (одинаково на всех процессах).
  */
-std::vector<int> generateGraph(int countVertices) {
-    std::srand(0);
+template <typename W, typename D, typename Rows>
+int dijkstra_mpi(const Rows &local_rows, D *local_dist, int *local_pred, const BlockPartition &partition, int start, int target, MPI_Comm comm, const SimdKernels<W, D> &kernels, int num_threads, RunProfile *profile = nullptr) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
 
-    int n = countVertices;
-    std::vector<int> flat(n * n);
+    const int total_nodes = partition.total;
+    const int rows_per_proc = partition.size(rank);
 
-    for (int i = 0; i < n; ++i) {
-        for (int j = i; j < n; ++j) {
-            int value;
-            if (i == j) {
-                value = 0;
-            } else {
-                value = std::rand() % 100;
+    // Вспомогательные структуры
+    MinLocPair<D> global_min_pair{distInfinity<D>(), -1}; // {min_dist, global_index}
+    MinLocPair<D> local_min_pair{distInfinity<D>(), -1};
+    const int row_length = local_rows.rowLength();
+    std::vector<W> u_row_buffer(row_length);
+    std::vector<W> u_weights(rows_per_proc); // свой отрезок строки u, собранный из упакованной раскладки
+
+    // Инициализация локальных массивов расстояний и предков
+    for (int i = 0; i < rows_per_proc; ++i) {
+        local_dist[i] = distInfinity<D>();
+        local_pred[i] = -1;
+    }
+
+    const int my_block_begin = partition.begin(rank);
+    const int my_block_end = my_block_begin + rows_per_proc;
+    if (start >= my_block_begin && start < my_block_end) {
+        int local_start_index = start - my_block_begin;
+        local_dist[local_start_index] = 0;
+    }
+
+    // Отрезки своих вершин по потокам
+    num_threads = std::max(1, std::min(num_threads, rows_per_proc));
+    const BlockPartition slices(rows_per_proc, num_threads);
+    std::vector<ThreadArgmin<D>> thread_min(num_threads);
+    SpinBarrier barrier(num_threads);
+    int u_global_idx = -1;                     // записывает поток 0, читают все после барьера
+    D current_dist = distInfinity<D>();
+    bool reached_target = false;               // MINLOC выбрал цель: её расстояние окончательно
+    int settled_local = 0;                     // посещённые свои вершины (для счётчика попыток релаксации)
+    int settled = 0;
+    std::vector<std::uint64_t> thread_updates(num_threads, 0);
+
+    runThreadTeam(num_threads, [&](int t) {
+        const int lo = slices.begin(t), len = slices.size(t);
+        RunProfile *timing = t == 0 ? profile : nullptr;
+        std::uint64_t updates = 0;
+        ActiveSet<D> active;
+        active.assign(local_dist + lo, len);
+
+        // Основной цикл: n итераций выбора минимальной вершины
+        for (int iteration = 0; iteration < total_nodes; ++iteration) {
+            // Каждый поток находит минимальную непосещённую вершину своего отрезка
+            int best = -1;
+            {
+                PhaseTimer timer(timing, kPhaseSelect);
+                best = kernels.argmin_active(active.dist(), active.size());
+                thread_min[t] = best == -1 ? ThreadArgmin<D>{} : ThreadArgmin<D>{active.dist()[best], lo + active.vertex(best)};
             }
-            
-            // симметрия для неориентированного графа
-            flat[i * n + j] = value;
-            flat[j * n + i] = value;
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
+            }
+
+            if (t == 0) {
+                ThreadArgmin<D> local_best = reduceThreadArgmin(thread_min);
+                local_min_pair = {local_best.dist, local_best.index == -1 ? -1 : my_block_begin + local_best.index}; // глобальный индекс
+
+                // Сверяем локальные минимумы по всем процессам — используем MPI_MINLOC
+                profileBarrier(profile, comm);
+                {
+                    PhaseTimer timer(profile, kPhaseReduce);
+                    MPI_Allreduce(&local_min_pair, &global_min_pair, 1, MinLocPair<D>::type(), MPI_MINLOC, comm);
+                }
+                u_global_idx = global_min_pair.index;
+                reached_target = u_global_idx != -1 && u_global_idx == target;
+
+                if (u_global_idx != -1) {
+                    current_dist = global_min_pair.dist;
+                    ++settled;
+                    if (rank == partition.owner(u_global_idx)) ++settled_local;
+                }
+
+                // Строка цели не рассылается: её расстояние окончательно, цикл завершается
+                if (u_global_idx != -1 && !reached_target) {
+                    int owner_rank = partition.owner(u_global_idx);
+                    if (rank == owner_rank) {
+                        // Владелец вершины отправляет хранимую часть своей строки смежности
+                        const W *stored = local_rows.storedRow(u_global_idx, u_row_buffer.data());
+                        if (stored != u_row_buffer.data()) std::memcpy(u_row_buffer.data(), stored, row_length * sizeof(W));
+                    }
+
+                    // Широковещательно передаём расстояние и строку смежности владельцем
+                    PhaseTimer timer(profile, kPhaseBcast);
+                    MPI_Bcast(&current_dist, 1, mpiDistType<D>(), owner_rank, comm);
+                    MPI_Bcast(u_row_buffer.data(), row_length * static_cast<int>(sizeof(W)), MPI_BYTE, owner_rank, comm);
+                }
+                if (profile) {
+                    profile->bytes += 2 * sizeof(local_min_pair);
+                    if (u_global_idx != -1 && !reached_target) {
+                        profile->bytes += sizeof(D) + static_cast<std::uint64_t>(row_length) * sizeof(W);
+                        profile->relax_attempted += rows_per_proc - settled_local;
+                        ++profile->iterations;
+                    }
+                }
+            }
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
+            }
+            // Выбранная вершина — кандидат ровно одного потока: он и убирает её из своего списка
+            if (best != -1 && u_global_idx == my_block_begin + lo + active.vertex(best)) active.settle(best, local_dist + lo);
+            if (u_global_idx == -1 || reached_target) break; // больше нет достижимых вершин или цель найдена
+
+            // Обновляем локальные расстояния, используя свой отрезок полученной строки смежности
+            PhaseTimer timer(timing, kPhaseRelax);
+            const W *row = local_rows.rowWeights(u_row_buffer.data(), u_global_idx, my_block_begin + lo, len, u_weights.data() + lo);
+            updates += kernels.relax_active(row, current_dist, u_global_idx, active.ids(), active.dist(), local_pred + lo, active.size());
         }
+        active.flush(local_dist + lo);
+        thread_updates[t] = updates;
+    });
+    if (profile) {
+        for (std::uint64_t updates : thread_updates) profile->relax_successful += updates;
     }
-
-    return flat;
+    return settled;
 }
 
-
 /**
- * @brief Параллельная реализация алгоритма Дейкстры с использованием MPI.
+ * @brief Параллельный Дейкстра с минимальной коммуникацией: одна MINLOC-редукция на итерацию.
+ *
+ * Вместо рассылки строки смежности владельцем каждый процесс хранит столбцовый блок
+ * матрицы: веса всех рёбер (u -> v) для своих вершин v. Расстояние до выбранной
+ * вершины u уже приходит в результате MPI_Allreduce, поэтому MPI_Bcast не нужен.
+ * Подходит и для ориентированных графов. Потоки делят вершины процесса и держат
+ * сжатые списки непосещённых вершин, как в dijkstra_mpi.
  *
- * @param loc_adj_ptr Указатель на локальную подматрицу смежности (строчно разбита по процессам).
- * @param loc_dist_ptr Указатель на массив локальных расстояний (размер = rows_per_proc).
- * @param loc_pred_ptr Указатель на массив предков (размер = rows_per_proc).
- * @param total_nodes Общее число вершин в графе.
- * @param rows_per_proc Число строк (вершин) на один процесс.
+ * @tparam W Тип веса матрицы (uint8_t, uint16_t или int).
+ * @tparam D Тип расстояния (int или std::int64_t).
+ * @param local_in_weights Столбцовый блок: local_in_weights[u * partition.size(rank) + local_v] = w(u, v).
+ * @param local_dist Указатель на массив локальных расстояний (размер = partition.size(rank)).
+ * @param local_pred Указатель на массив предков (размер = partition.size(rank)).
+ * @param partition Разбиение вершин по процессам.
  * @param start Начальная вершина (глобальный индекс).
+ * @param target Целевая вершина (-1 — все вершины), см. dijkstra_mpi.
  * @param comm MPI-коммуникатор.
+ * @param kernels Ядра поиска минимума и релаксации (selectSimdKernels).
+ * @param num_threads Число потоков внутри процесса.
+ * @param profile [out] Профиль запуска (nullptr — без профилирования); фазы замеряет поток 0.
+ * @return Число посещённых вершин (одинаково на всех процессах).
  */
-void dijkstra_mpi(int *local_graph_matrix, int *local_dist, int *local_pred, int total_nodes, int rows_per_proc, int start, MPI_Comm comm) {
-    int rank = 0, num_procs = 1;
+template <typename W, typename D>
+int dijkstra_mpi_minimal(const W *local_in_weights, D *local_dist, int *local_pred, const BlockPartition &partition, int start, int target, MPI_Comm comm, const SimdKernels<W, D> &kernels, int num_threads, RunProfile *profile = nullptr) {
+    int rank = 0;
     MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &num_procs);
 
-    // Вспомогательные структуры
-    std::vector<int> visited(rows_per_proc, 0);
-    std::array<int, 2> global_min_pair{INF, -1}; // {min_dist, global_index}
-    std::array<int, 2> local_min_pair{INF, -1};
-    std::vector<int> u_row_buffer(total_nodes);
+    const int total_nodes = partition.total;
+    const int rows_per_proc = partition.size(rank);
+
+    MinLocPair<D> global_min_pair{distInfinity<D>(), -1}; // {min_dist, global_index}
+    MinLocPair<D> local_min_pair{distInfinity<D>(), -1};
 
-    // Инициализация локальных массивов расстояний и предков
     for (int i = 0; i < rows_per_proc; ++i) {
-        local_dist[i] = INF;
+        local_dist[i] = distInfinity<D>();
         local_pred[i] = -1;
     }
 
-    const int my_block_begin = rank * rows_per_proc;
+    const int my_block_begin = partition.begin(rank);
     const int my_block_end = my_block_begin + rows_per_proc;
     if (start >= my_block_begin && start < my_block_end) {
-        int local_start_index = start - my_block_begin;
-        local_dist[local_start_index] = 0;
+        local_dist[start - my_block_begin] = 0;
     }
 
-    // Основной цикл: n итераций выбора минимальной вершины
-    for (int iteration = 0; iteration < total_nodes; ++iteration) {
-        local_min_pair = {INF, -1};
+    num_threads = std::max(1, std::min(num_threads, rows_per_proc));
+    const BlockPartition slices(rows_per_proc, num_threads);
+    std::vector<ThreadArgmin<D>> thread_min(num_threads);
+    SpinBarrier barrier(num_threads);
+    int settled_local = 0;
+    int settled = 0;
+    std::vector<std::uint64_t> thread_updates(num_threads, 0);
 
-        // Находим минимальную непосещённую локальную вершину
-        for (int i = 0; i < rows_per_proc; ++i) {
-            if (!visited[i] && local_dist[i] < local_min_pair[0]) {
-                local_min_pair[0] = local_dist[i];
-                local_min_pair[1] = rank * rows_per_proc + i; // глобальный индекс
+    runThreadTeam(num_threads, [&](int t) {
+        const int lo = slices.begin(t), len = slices.size(t);
+        RunProfile *timing = t == 0 ? profile : nullptr;
+        std::uint64_t updates = 0;
+        ActiveSet<D> active;
+        active.assign(local_dist + lo, len);
+
+        for (int iteration = 0; iteration < total_nodes; ++iteration) {
+            int best = -1;
+            {
+                PhaseTimer timer(timing, kPhaseSelect);
+                best = kernels.argmin_active(active.dist(), active.size());
+                thread_min[t] = best == -1 ? ThreadArgmin<D>{} : ThreadArgmin<D>{active.dist()[best], lo + active.vertex(best)};
+            }
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
             }
-        }
 
-        // Сверяем локальные минимумы по всем процессам — используем MPI_MINLOC
-        MPI_Allreduce(local_min_pair.data(), global_min_pair.data(), 1, MPI_2INT, MPI_MINLOC, comm);
+            if (t == 0) {
+                ThreadArgmin<D> local_best = reduceThreadArgmin(thread_min);
+                local_min_pair = {local_best.dist, local_best.index == -1 ? -1 : my_block_begin + local_best.index};
+
+                // Единственная коллективная операция за итерацию
+                profileBarrier(profile, comm);
+                {
+                    PhaseTimer timer(profile, kPhaseReduce);
+                    MPI_Allreduce(&local_min_pair, &global_min_pair, 1, MinLocPair<D>::type(), MPI_MINLOC, comm);
+                }
 
-        int u_global_idx = global_min_pair[1];
-        if (u_global_idx == -1) break; // больше недостижимых вершин
+                int u = global_min_pair.index;
+                if (u >= my_block_begin && u < my_block_end) ++settled_local;
+                if (u != -1) ++settled;
+                if (profile) {
+                    profile->bytes += 2 * sizeof(local_min_pair);
+                    if (u != -1 && u != target) {
+                        profile->relax_attempted += rows_per_proc - settled_local;
+                        ++profile->iterations;
+                    }
+                }
+            }
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
+            }
 
-        int owner_rank = u_global_idx / rows_per_proc;
-        int local_u_idx = u_global_idx % rows_per_proc;
-        if (rank == owner_rank) visited[local_u_idx] = 1;
+            int u_global_idx = global_min_pair.index;
+            if (best != -1 && u_global_idx == my_block_begin + lo + active.vertex(best)) active.settle(best, local_dist + lo);
+            if (u_global_idx == -1 || u_global_idx == target) break;
 
-        int current_dist = global_min_pair[0];
-        if (rank == owner_rank) {
-            // Владелец вершины отправляет всю свою строку смежности
-            std::memcpy(u_row_buffer.data(), &local_graph_matrix[local_u_idx * total_nodes], total_nodes * sizeof(int));
+            D current_dist = global_min_pair.dist;
+            const W *u_weights = &local_in_weights[static_cast<std::size_t>(u_global_idx) * rows_per_proc];
+            PhaseTimer timer(timing, kPhaseRelax);
+            updates += kernels.relax_active(u_weights + lo, current_dist, u_global_idx, active.ids(), active.dist(), local_pred + lo, active.size());
         }
+        active.flush(local_dist + lo);
+        thread_updates[t] = updates;
+    });
+    if (profile) {
+        for (std::uint64_t updates : thread_updates) profile->relax_successful += updates;
+    }
+    return settled;
+}
 
-        // Широковещательно передаём расстояние и строку смежности владельцем
-        MPI_Bcast(&current_dist, 1, MPI_INT, owner_rank, comm);
-        MPI_Bcast(u_row_buffer.data(), total_nodes, MPI_INT, owner_rank, comm);
+/**
+ * @brief Пакетный режим: источники распределяются по процессам, граф реплицируется.
+ *
+ * Каждый процесс держит всю матрицу (сгенерированную или прочитанную им самим)
+ * и обрабатывает свою долю источников min-plus ядром batchShortestPaths группами по batch_size.
+ * Блоки расстояний собираются на процессе 0 через MPI_Gatherv; единица сбора — строка блока
+ * (n расстояний одного источника), поэтому счётчики не переполняются и при K * n > INT_MAX.
+ * @param graph Матрица смежности n*n типа W (на каждом процессе).
+ * @param output_path Файл для блока расстояний K*n (пустая строка — не сохранять).
+ */
+template <typename W>
+int runBatchMode(const W *graph, int total_nodes, const std::vector<int> &sources, int batch_size, SimdLevel simd_level,
+                 const std::string &output_path, double read_start_time, MPI_Comm comm) {
+    int rank = 0, num_procs = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_procs);
 
-        // Обновляем локальные расстояния, используя полученную строку смежности
-        for (int local_v = 0; local_v < rows_per_proc; ++local_v) {
-            if (!visited[local_v]) {
-                int global_v = rank * rows_per_proc + local_v;
-                int weight = u_row_buffer[global_v];
+    const int n = total_nodes;
 
-                if (weight != INF && current_dist != INF && current_dist <= INF - weight) {
-                    int candidate = current_dist + weight;
+    // Источники делятся блоками: первые (K % p) процессов получают на один больше
+    const int num_sources = static_cast<int>(sources.size());
+    std::vector<int> source_counts(num_procs), source_displs(num_procs);
+    for (int p = 0, offset = 0; p < num_procs; ++p) {
+        source_counts[p] = num_sources / num_procs + (p < num_sources % num_procs ? 1 : 0);
+        source_displs[p] = offset;
+        offset += source_counts[p];
+    }
+    const int my_count = source_counts[rank];
+    const int *my_sources = sources.data() + source_displs[rank];
 
-                    if (candidate < local_dist[local_v]) {
-                        local_dist[local_v] = candidate;
-                        local_pred[local_v] = u_global_idx;
-                    }
-                }
+    std::vector<int> local_dist(static_cast<std::size_t>(my_count) * n);
+    std::vector<int> local_pred(static_cast<std::size_t>(my_count) * n);
+
+    MPI_Barrier(comm);
+    double parallel_start_time = MPI_Wtime();
+
+    RowBlockKernel<W> relax_block = selectRowBlockKernel<W>(simd_level);
+    const int delta = batchBucketWidth(graph, n);
+    unsigned long long local_row_loads = 0;
+    for (int first = 0; first < my_count; first += batch_size) {
+        int count = std::min(batch_size, my_count - first);
+        std::size_t offset = static_cast<std::size_t>(first) * n;
+        local_row_loads += batchShortestPaths(graph, n, my_sources + first, count, local_dist.data() + offset, local_pred.data() + offset,
+                                              relax_block, delta);
+    }
+
+    MPI_Barrier(comm);
+    double parallel_end_time = MPI_Wtime();
+
+    // Сбор блока расстояний K*n на корневом процессе: счётчики и смещения — в строках блока
+    MPI_Datatype row_type;
+    MPI_Type_contiguous(n, MPI_INT, &row_type);
+    MPI_Type_commit(&row_type);
+    std::vector<int> global_dist;
+    if (rank == 0) global_dist.resize(static_cast<std::size_t>(num_sources) * n);
+    MPI_Gatherv(local_dist.data(), my_count, row_type, global_dist.data(), source_counts.data(), source_displs.data(), row_type, 0, comm);
+    MPI_Type_free(&row_type);
+
+    unsigned long long row_loads = 0;
+    MPI_Reduce(&local_row_loads, &row_loads, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+
+    int status = 0;
+    if (rank == 0) {
+        double compute_time = parallel_end_time - parallel_start_time;
+        std::printf("total_nodes: %d \n", n);
+        std::printf("Engine: batch min-plus, sources: %d, batch: %d, row loads: %llu (%.3f of single-source runs)\n", num_sources, batch_size,
+                    row_loads, static_cast<double>(row_loads) / (static_cast<double>(num_sources) * n));
+        std::printf("Compute time: %.6f seconds (%.6f per source)\n", compute_time, compute_time / num_sources);
+        std::printf("Matrix load time: %.6f s\n\n", parallel_start_time - read_start_time);
+
+        if (!output_path.empty()) {
+            if (writeDistanceBlock(output_path, sources, n, global_dist.data())) {
+                std::printf("Distance block %dx%d written to %s\n", num_sources, n, output_path.c_str());
+            } else {
+                std::fprintf(stderr, "Ошибка записи блока расстояний в %s\n", output_path.c_str());
+                status = 1;
             }
         }
     }
+
+    return status;
 }
 
 /**
  * @brief Точка входа: чтение графа, распределение по процессам и запуск Dijkstra.
  *
- * Ожидает один аргумент: путь к файлу с графом. Матрица смежности должна быть
- * представлена как плоский массив целых (row-major).
+ * Параметры: [total_nodes] [--comm=bcast|minimal] [--engine=dijkstra|delta] [--delta=D].
+ * --comm=bcast   — исходная схема: владелец вершины рассылает строку смежности;
+ * --comm=minimal — процессы хранят столбцовые блоки, за итерацию выполняется только MPI_Allreduce;
+ * --engine=delta — распределённый delta-stepping по локальным CSR-блокам строк
+ *                  (D — ширина корзины, 0 — автоподбор);
+ * --simd=auto|scalar|sse4|avx2|avx512 — ядра поиска минимума и релаксации (по умолчанию — лучшие для процессора);
+ * --sources=all|s1,a-b,... — пакетный режим: источники делятся между процессами
+ *                  ([--batch=K] — размер группы, [--batch-output=file] — файл блока расстояний);
+ * --graph=file   — граф из бинарного файла (см. graph_file.hpp): каждый процесс читает
+ *                  свой блок через MPI-IO, без рассылки матрицы с процесса 0;
+ * --seed=S --density=P --min-weight=A --max-weight=B — параметры генератора: без --graph
+ *                  каждый процесс сам генерирует свой блок (см. graph_generator.hpp);
+ * --weight-bytes=auto|1|2|4 — ширина веса плотных блоков для сгенерированного графа
+ *                  (auto — самая узкая для --max-weight; для --graph ширину задаёт файл);
+ * --dist-bits=32|64 — разрядность расстояний --engine=dijkstra (64 — скалярные ядра). Запуск
+ *                  с 32-битными расстояниями отклоняется, если (n - 1) * max_weight не меньше INT_MAX;
+ * --storage=full|packed — раскладка блока строк для --engine=dijkstra --comm=bcast --partition=1d:
+ *                  packed хранит симметричную матрицу один раз (около n/2 весов на строку, см. row_block.hpp),
+ *                  вдвое уменьшая и память процесса, и объём рассылки строки;
+ * --partition=1d|2d — 1d: блоки подряд идущих вершин, размеры отличаются не более чем на одну
+ *                  (число процессов не обязано делить total_nodes); 2d: решётка q x q процессов
+ *                  с блоками матрицы (p — полный квадрат, только --engine=dijkstra --comm=bcast);
+ * --threads=T    — гибридный режим: T потоков на процесс делят его вершины при поиске минимума
+ *                  и релаксации, MPI вызывает только главный поток (MPI_THREAD_FUNNELED).
+ *                  Позволяет запускать один процесс на узел/NUMA-домен вместо процесса на ядро;
+ * --source=S --target=T — начальная вершина (по умолчанию 0) и запрос "точка — точка":
+ *                  движки останавливаются, как только MINLOC выбирает цель (delta — после корзины цели),
+ *                  процесс 0 восстанавливает путь по собранному массиву предков;
+ * --reorder=none|rcm|degree|bfs — перенумерация вершин для --engine=delta: процесс 0 собирает граф
+ *                  (ему нужна память O(n + m) под весь граф), переставляет его (см. reorder.hpp) и раздаёт
+ *                  блоки новой нумерации, так что у соседей чаще один владелец; печатаются дуги разреза
+ *                  до и после и ускорение против исходной нумерации;
+ * --output=file  — бинарный файл результата (dist и pred, см. result_file.hpp): каждый процесс пишет
+ *                  свой отрезок вершин через MPI-IO (при --reorder — переведённый к исходным номерам),
+ *                  массивы на процессе 0 собираются только для --target и сверки --reorder;
+ *                  пути по файлу восстанавливает path_query;
+ * --pages=small|thp|huge --numa=default|interleave|partition — размещение блока матрицы и dist/pred
+ *                  (см. memory_placement.hpp): partition закрепляет память процесса за узлом NUMA
+ *                  по его номеру среди процессов узла, внутри процесса полосы делятся между потоками;
+ * --serve [--socket=path] [--cache=K] — режим сервера: граф загружается один раз, процесс 0
+ *                  принимает запросы "S" / "S T" из stdin или Unix-сокета и держит LRU-кэш
+ *                  K деревьев путей, на промахе все процессы считают запрос (см. query_server.hpp);
+ * --profile      — время по фазам (выбор вершины, MINLOC, рассылка, релаксация, обмен, ожидание),
+ *                  объём обмена и счётчики релаксаций: min/avg/max по процессам на процессе 0
+ *                  ([--trace=file] — CSV с показателями каждого процесса).
  */
 int main(int argc, char *argv[]) {
-    // Инициализация
-    MPI_Init(&argc, &argv);
+    // Инициализация: MPI вызывает только главный поток, рабочие потоки лишь считают
+    int thread_support = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
     MPI_Comm comm = MPI_COMM_WORLD;
     int rank = 0, num_procs = 1;
     MPI_Comm_rank(comm, &rank);      // Cохраняет в rank номер текущего процесса
     MPI_Comm_size(comm, &num_procs); // Cохраняет в num_proc количество процессов
 
     int total_nodes = 200;
+    std::string comm_mode = "bcast"; // bcast | minimal
+    std::string engine = "dijkstra"; // dijkstra | delta
+    int delta = 0; // 0 — автоподбор по диапазону весов (только для delta)
+    std::string sources_spec;  // пакетный режим: "all" или "0,5,7"
+    int batch_size = 32;       // число источников, обрабатываемых вместе
+    std::string batch_output;  // файл для блока расстояний K*n
+    std::string graph_path;    // бинарный файл графа; пусто — генерация
+    GeneratorParams generator; // параметры генерации
+    std::uint32_t weight_bytes = 0; // ширина веса плотных блоков: 0 — по графу
+    int dist_bits = 32;             // разрядность расстояний движка dijkstra
+    std::string partition_mode = "1d"; // 1d | 2d
+    std::string storage = "full";      // раскладка блока строк: full | packed
+    int num_threads = 1; // потоков на процесс (гибридный режим MPI + потоки)
+    int start_vertex = 0;
+    int target_vertex = -1; // запрос "точка — точка": остановка на цели и вывод пути
+    bool serve = false;        // режим сервера: граф остаётся в памяти, запросы принимает процесс 0
+    std::string socket_path;   // Unix-сокет сервера (пусто — stdin процесса 0)
+    int cache_size = 16;       // деревьев кратчайших путей в LRU-кэше процесса 0
+    bool profiling = false;    // профиль фаз, объёма обмена и релаксаций
+    std::string trace_path;    // CSV с профилем каждого процесса
+    SimdLevel simd_level = detectSimdLevel();
+    VertexOrder reorder = VertexOrder::None; // перенумерация вершин перед разбиением на блоки
+    std::string output_path;   // бинарный файл результата dist/pred (common/result_file.hpp)
+    MemoryPlacement placement; // страницы и узлы NUMA блока матрицы и dist/pred (common/memory_placement.hpp)
 
-    // Проверяем, передан ли параметр
-    if (argc > 1) {
-        try {
-            total_nodes = std::stoi(argv[1]);
-        } catch (const std::exception &e) {
-            std::cerr << "Некорректный параметр total_nodes: " << argv[1] << "\n";
-            return 1;
+    // Проверяем, переданы ли параметры
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseGeneratorOption(argv[i], generator)) {
+            continue;
+        } else if (parseOption(argv[i], "--comm", value)) {
+            comm_mode = value;
+        } else if (parseOption(argv[i], "--engine", value)) {
+            engine = value;
+        } else if (parseOption(argv[i], "--delta", value)) {
+            delta = std::stoi(value);
+        } else if (parseOption(argv[i], "--sources", value)) {
+            sources_spec = value;
+        } else if (parseOption(argv[i], "--batch", value)) {
+            batch_size = std::stoi(value);
+        } else if (parseOption(argv[i], "--batch-output", value)) {
+            batch_output = value;
+        } else if (parseOption(argv[i], "--graph", value)) {
+            graph_path = value;
+        } else if (parseOption(argv[i], "--weight-bytes", value)) {
+            weight_bytes = value == "auto" ? 0 : static_cast<std::uint32_t>(std::stoul(value));
+        } else if (parseOption(argv[i], "--dist-bits", value)) {
+            dist_bits = std::stoi(value);
+        } else if (parseFlag(argv[i], "--profile")) {
+            profiling = true;
+        } else if (parseOption(argv[i], "--trace", value)) {
+            trace_path = value;
+            profiling = true;
+        } else if (parseOption(argv[i], "--threads", value)) {
+            num_threads = std::stoi(value);
+        } else if (parseOption(argv[i], "--partition", value)) {
+            partition_mode = value;
+        } else if (parseOption(argv[i], "--storage", value)) {
+            storage = value;
+        } else if (parseOption(argv[i], "--source", value)) {
+            start_vertex = std::stoi(value);
+        } else if (parseOption(argv[i], "--target", value)) {
+            target_vertex = std::stoi(value);
+        } else if (parseFlag(argv[i], "--serve")) {
+            serve = true;
+        } else if (parseOption(argv[i], "--socket", value)) {
+            socket_path = value;
+            serve = true;
+        } else if (parseOption(argv[i], "--cache", value)) {
+            cache_size = std::stoi(value);
+        } else if (parseOption(argv[i], "--pages", value)) {
+            if (!parsePageMode(value, placement.pages)) {
+                if (rank == 0) {
+                    std::cerr << "Неизвестный размер страниц: " << value << " (ожидается small, thp или huge)\n";
+                }
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--numa", value)) {
+            if (!parseNumaMode(value, placement.numa)) {
+                if (rank == 0) {
+                    std::cerr << "Неизвестное размещение NUMA: " << value << " (ожидается default, interleave или partition)\n";
+                }
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--output", value)) {
+            output_path = value;
+        } else if (parseOption(argv[i], "--reorder", value)) {
+            if (!parseVertexOrder(value, reorder)) {
+                if (rank == 0) {
+                    std::cerr << "Неизвестный порядок вершин: " << value << " (ожидается none, rcm, degree или bfs)\n";
+                }
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--simd", value)) {
+            if (!parseSimdLevel(value, simd_level)) {
+                if (rank == 0) {
+                    std::cerr << "Неизвестный уровень SIMD: " << value << " (ожидается auto, scalar, sse4, avx2 или avx512)\n";
+                }
+                MPI_Finalize();
+                return 1;
+            }
+        } else {
+            try {
+                total_nodes = std::stoi(argv[i]);
+            } catch (const std::exception &e) {
+                std::cerr << "Некорректный параметр total_nodes: " << argv[i] << "\n";
+                return 1;
+            }
         }
     }
 
+    if (comm_mode != "bcast" && comm_mode != "minimal") {
+        if (rank == 0) {
+            std::cerr << "Неизвестный режим коммуникации: " << comm_mode << " (ожидается bcast или minimal)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (engine != "dijkstra" && engine != "delta") {
+        if (rank == 0) {
+            std::cerr << "Неизвестный движок: " << engine << " (ожидается dijkstra или delta)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (engine == "delta" && comm_mode == "minimal") {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --engine=delta использует блоки строк и несовместим с --comm=minimal\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (partition_mode != "1d" && partition_mode != "2d") {
+        if (rank == 0) {
+            std::cerr << "Неизвестное разбиение: " << partition_mode << " (ожидается 1d или 2d)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    const bool grid_2d = (partition_mode == "2d");
+    const int grid_side = gridSide(num_procs);
+    if (grid_2d && (engine != "dijkstra" || comm_mode != "bcast")) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --partition=2d поддерживается только для --engine=dijkstra --comm=bcast\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (grid_2d && grid_side == 0) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --partition=2d требует число процессов — полный квадрат (4, 9, 16, ...), получено " << num_procs << "\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (storage != "full" && storage != "packed") {
+        if (rank == 0) {
+            std::cerr << "Неизвестная раскладка матрицы: " << storage << " (ожидается full или packed)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    const bool packed = (storage == "packed");
+    if (packed && (engine != "dijkstra" || comm_mode != "bcast" || grid_2d || !sources_spec.empty())) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --storage=packed поддерживается только для --engine=dijkstra --comm=bcast --partition=1d (без --sources)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (reorder != VertexOrder::None && (engine != "delta" || !sources_spec.empty())) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --reorder поддерживается только для --engine=delta (без --sources)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (num_threads < 1) {
+        if (rank == 0) {
+            std::cerr << "Некорректное число потоков: " << num_threads << " (ожидается >= 1)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (num_threads > 1 && (engine != "dijkstra" || !sources_spec.empty())) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --threads поддерживается только для --engine=dijkstra (без --sources)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (target_vertex >= 0 && !sources_spec.empty()) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --target несовместим с пакетным режимом --sources\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (!output_path.empty() && (serve || !sources_spec.empty())) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --output несовместим с --serve и --sources (для пакетного режима — --batch-output)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (serve && (!sources_spec.empty() || profiling || cache_size < 0)) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --serve несовместим с --sources и --profile, --cache должен быть >= 0\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (profiling && !sources_spec.empty()) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --profile не поддерживается в пакетном режиме (--sources)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (num_threads > 1 && thread_support < MPI_THREAD_FUNNELED) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: библиотека MPI не поддерживает MPI_THREAD_FUNNELED, --threads недоступен\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    std::string generator_error;
+    if (!validateGeneratorParams(generator, generator_error)) {
+        if (rank == 0) {
+            std::cerr << "Некорректные параметры генератора: " << generator_error << "\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (weight_bytes != 0 && weight_bytes != 1 && weight_bytes != 2 && weight_bytes != 4) {
+        if (rank == 0) {
+            std::cerr << "Некорректная ширина веса: " << weight_bytes << " (ожидается auto, 1, 2 или 4)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (dist_bits != 32 && dist_bits != 64) {
+        if (rank == 0) {
+            std::cerr << "Некорректная разрядность расстояний: " << dist_bits << " (ожидается 32 или 64)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (dist_bits == 64 && (engine != "dijkstra" || !sources_spec.empty())) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --dist-bits=64 поддерживается только для --engine=dijkstra (без --sources)\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    const bool minimal_comm = (comm_mode == "minimal");
+
+    // Ядра с 32-битными расстояниями насыщаются на INF: путь длиннее INT_MAX молча стал бы «недостижимым»
+    auto reject_int_distances = [&](int max_weight) {
+        if (fitsIntDistances(total_nodes, max_weight)) return false;
+        if (rank == 0) {
+            std::cerr << "Ошибка: пути до (n - 1) * max_weight = " << static_cast<long long>(total_nodes - 1) * max_weight
+                      << " не помещаются в 32-битные расстояния (для --engine=dijkstra без --sources — --dist-bits=64)\n";
+        }
+        return true;
+    };
+
     // Сохраняем время
     MPI_Barrier(comm);
     double read_start_time = MPI_Wtime();
 
 
-    std::vector<int> graph_matrix;
+    const bool from_file = !graph_path.empty();
+    MPI_File graph_file = MPI_FILE_NULL;
+    GraphFileHeader graph_header{};
 
-    if (rank == 0) {
-        graph_matrix = generateGraph(total_nodes);
+    if (from_file) {
+        // Заголовок читают все процессы, число вершин известно без рассылки
+        std::string error;
+        if (!openGraphFileMpi(graph_path, graph_file, graph_header, error, comm)) {
+            if (rank == 0) {
+                std::cerr << "Ошибка чтения графа: " << error << "\n";
+            }
+            MPI_Finalize();
+            return 1;
+        }
+        total_nodes = static_cast<int>(graph_header.num_vertices);
+        weight_bytes = graph_header.weight_bytes; // тип веса задаёт файл
+    } else if (weight_bytes == 0) {
+        weight_bytes = weightBytesFor(generator.max_weight);
+    } else if (generator.max_weight > dispatchWeightType(weight_bytes, [](auto tag) { return WeightTraits<decltype(tag)>::kMaxWeight; })) {
+        if (rank == 0) {
+            std::cerr << "--max-weight=" << generator.max_weight << " не помещается в --weight-bytes=" << weight_bytes << "\n";
+        }
+        MPI_Finalize();
+        return 1;
     }
 
-    // Передаём число вершин всем процессам
-    MPI_Bcast(&total_nodes, 1, MPI_INT, 0, comm);
+    if (!sources_spec.empty()) {
+        std::vector<int> sources;
+        std::string sources_error;
+        if (!parseSourceList(sources_spec, total_nodes, sources, sources_error)) {
+            if (rank == 0) {
+                std::cerr << "Некорректный список источников " << sources_spec << ": " << sources_error << "\n";
+            }
+            if (from_file) MPI_File_close(&graph_file);
+            MPI_Finalize();
+            return 1;
+        }
+        int status = dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            // Пакетному режиму нужна вся матрица на каждом процессе: читаем или генерируем её целиком
+            std::vector<W> graph_matrix(static_cast<std::size_t>(total_nodes) * total_nodes);
+            if (!from_file) {
+                generateDenseRows(generator, total_nodes, 0, total_nodes, graph_matrix.data());
+            } else {
+                if (graph_header.layout == kLayoutDense) {
+                    readDenseRowBlockMpi(graph_file, graph_header, 0, total_nodes, graph_matrix.data());
+                } else {
+                    CsrGraph rows;
+                    std::string error;
+                    bool read = readCsrRowBlockMpi(graph_file, graph_header, 0, total_nodes, rows, error, comm);
+                    MPI_File_close(&graph_file);
+                    if (!read) {
+                        if (rank == 0) std::cerr << "Ошибка чтения графа: " << error << "\n";
+                        return 1;
+                    }
+                    densifyCsrRows(rows, total_nodes, 0, false, graph_matrix.data());
+                }
+                if (graph_file != MPI_FILE_NULL) MPI_File_close(&graph_file);
+            }
+            // Матрица одинакова на всех процессах, поэтому и решение об отказе одинаково
+            if (reject_int_distances(from_file ? maxStoredWeight(graph_matrix.data(), graph_matrix.size()) : generator.max_weight)) return 1;
+            return runBatchMode(graph_matrix.data(), total_nodes, sources, std::max(1, batch_size), simd_level, batch_output, read_start_time, comm);
+        });
+        MPI_Finalize();
+        return status;
+    }
+
+    if (start_vertex < 0 || start_vertex >= total_nodes || target_vertex >= total_nodes) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: вершины --source/--target должны лежать в [0, " << total_nodes << ")\n";
+        }
+        if (from_file) MPI_File_close(&graph_file);
+        MPI_Finalize();
+        return 1;
+    }
 
-    if (num_procs > total_nodes || total_nodes % num_procs != 0) {
+    // Каждому процессу (или блоку решётки) нужна хотя бы одна вершина
+    const int num_blocks = grid_2d ? grid_side : num_procs;
+    if (num_blocks > total_nodes) {
         if (rank == 0) {
-            std::cerr << "Ошибка: total_nodes должно делиться на число процессов и быть >= их количества\n";
+            std::cerr << "Ошибка: total_nodes должно быть >= " << (grid_2d ? "стороны решётки процессов" : "числа процессов") << "\n";
         }
+        if (from_file) MPI_File_close(&graph_file);
         MPI_Finalize();
         return 1;
     }
 
-    int rows_per_proc = total_nodes / num_procs;
+    const BlockPartition partition(total_nodes, num_procs);
+    ProcessGrid grid;
+    if (grid_2d) grid = createProcessGrid(total_nodes, grid_side, comm);
     MPI_Barrier(comm);
 
+    // Вершины, расстояния до которых хранит процесс: свой блок (1D) или блок столбцов решётки (2D)
+    const int my_first_vertex = grid_2d ? grid.blocks.begin(grid.col) : partition.begin(rank);
+    const int my_num_vertices = grid_2d ? grid.blocks.size(grid.col) : partition.size(rank);
+
+    // Прямоугольник матрицы смежности, который хранит процесс:
+    // 1D — свои строки целиком (для --comm=minimal — свои столбцы целиком), 2D — блок решётки
+    int block_first_row = my_first_vertex, block_num_rows = my_num_vertices;
+    int block_first_col = 0, block_num_cols = total_nodes;
+    if (grid_2d) {
+        block_first_row = grid.blocks.begin(grid.row);
+        block_num_rows = grid.blocks.size(grid.row);
+        block_first_col = my_first_vertex;
+        block_num_cols = my_num_vertices;
+    } else if (minimal_comm) {
+        block_first_row = 0;
+        block_num_rows = total_nodes;
+        block_first_col = my_first_vertex;
+        block_num_cols = my_num_vertices;
+    }
+
+    // Процессы одного узла делят его узлы NUMA подряд, как блоки вершин: при partition память
+    // процесса закрепляется за «его» узлом NUMA, а полосы внутри процесса — за его потоками
+    placement.parts = num_threads;
+    if (placement.numa == NumaMode::Partition) {
+        MPI_Comm node_comm;
+        int node_rank = 0, node_size = 1;
+        MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_size(node_comm, &node_size);
+        MPI_Comm_free(&node_comm);
+        const int numa_nodes = numaNodeCount();
+        placement.first_node = static_cast<int>(static_cast<long long>(node_rank) * numa_nodes / node_size);
+        placement.num_nodes = std::max(1, numa_nodes / node_size);
+    }
+
     // Локальные буферы для каждого процесса
-    std::vector<int> local_graph_matrix(rows_per_proc * total_nodes);
-    std::vector<int> local_dist(rows_per_proc);
-    std::vector<int> local_pred(rows_per_proc);
+    PlacedArray<std::uint8_t> local_storage; // блок матрицы (веса ширины weight_bytes)
+    PlacedArray<int> local_dist, local_pred;
+    PlacedArray<std::int64_t> local_dist64; // расстояния при --dist-bits=64
+    local_dist.allocate(my_num_vertices, placement);
+    local_pred.allocate(my_num_vertices, placement);
+    if (dist_bits == 64) local_dist64.allocate(my_num_vertices, placement);
 
-    // Разбиваем плоскую матрицу по процессам (блоки строк)
-    if (rank == 0) {
-        for (int p = 0; p < num_procs; ++p) {
-            int offset = p * rows_per_proc * total_nodes;
+    const std::size_t local_block_size = static_cast<std::size_t>(block_num_rows) * block_num_cols;
+    CsrGraph local_csr;
 
-            if (p == 0) {
-                std::memcpy(local_graph_matrix.data(), graph_matrix.data() + offset, rows_per_proc * total_nodes * sizeof(int));
-                continue;
+    if (from_file && minimal_comm && graph_header.layout == kLayoutCsr && !(graph_header.flags & kFlagSymmetric)) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --comm=minimal с CSR-файлом требует симметричного графа (graph_convert --undirected)\n";
+        }
+        MPI_File_close(&graph_file);
+        MPI_Finalize();
+        return 1;
+    }
+    if (from_file && packed && !(graph_header.flags & kFlagSymmetric)) {
+        if (rank == 0) {
+            std::cerr << "Ошибка: --storage=packed требует неориентированного графа (graph_convert --undirected)\n";
+        }
+        MPI_File_close(&graph_file);
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::string load_error; // ошибка проверки CSR-файла (одинаковый исход на всех процессах)
+    dispatchWeightType(weight_bytes, [&](auto tag) {
+        using W = decltype(tag);
+        auto allocate_block = [&]() {
+            // Упакованный блок хранит полосы плиток, пересекающие свои вершины
+            std::size_t weights = packed ? PackedRowBlock<W>::blockSize(total_nodes, my_first_vertex, my_num_vertices) : local_block_size;
+            local_storage.allocate(weights * sizeof(W), placement);
+            return reinterpret_cast<W *>(local_storage.data());
+        };
+
+        if (from_file) {
+            // Каждый процесс читает только свой прямоугольник матрицы
+            if (packed && graph_header.layout == kLayoutCsr) {
+                const int first_tile_row = PackedRowBlock<W>::firstTileRow(my_first_vertex);
+                const int num_tile_rows = PackedRowBlock<W>::numTileRows(my_first_vertex, my_num_vertices);
+                const int first_row = first_tile_row * PackedRowBlock<W>::kTile;
+                const int num_rows = std::min((first_tile_row + num_tile_rows) * PackedRowBlock<W>::kTile, total_nodes) - first_row;
+                CsrGraph rows;
+                if (readCsrRowBlockMpi(graph_file, graph_header, first_row, num_rows, rows, load_error, comm)) {
+                    packCsrRows(rows, total_nodes, first_tile_row, num_tile_rows, allocate_block());
+                }
+            } else if (packed) {
+                readPackedRowBlockMpi(graph_file, graph_header, my_first_vertex, my_num_vertices, allocate_block(), comm);
+            } else if (graph_header.layout == kLayoutCsr && minimal_comm) {
+                // Столбцы симметричного графа — это транспонированные строки своих вершин
+                CsrGraph rows;
+                if (readCsrRowBlockMpi(graph_file, graph_header, my_first_vertex, my_num_vertices, rows, load_error, comm)) {
+                    densifyCsrRows(rows, total_nodes, my_first_vertex, true, allocate_block());
+                }
+            } else if (graph_header.layout == kLayoutCsr) {
+                CsrGraph rows;
+                bool read = readCsrRowBlockMpi(graph_file, graph_header, block_first_row, block_num_rows, rows, load_error, comm);
+                if (read && engine == "delta") {
+                    local_csr = std::move(rows);
+                } else if (read) {
+                    densifyCsrBlock(rows, block_first_row, block_first_col, block_num_cols, allocate_block());
+                }
+            } else {
+                readDenseBlockMpi(graph_file, graph_header, block_first_row, block_num_rows, block_first_col, block_num_cols, allocate_block());
             }
-            
-            MPI_Send(graph_matrix.data() + offset, rows_per_proc * total_nodes, MPI_INT, p, 0, comm);
+            MPI_File_close(&graph_file);
+        } else if (engine == "delta") {
+            // Каждый процесс генерирует только свой блок: матрица n*n нигде не собирается целиком
+            local_csr = generateCsrRows(generator, total_nodes, my_first_vertex, my_num_vertices);
+        } else if (packed) {
+            packGeneratedRows(generator, total_nodes, my_first_vertex, my_num_vertices, allocate_block());
+        } else {
+            generateDenseBlock(generator, block_first_row, block_num_rows, block_first_col, block_num_cols, allocate_block());
+        }
+
+        // Для delta-stepping строим локальный CSR исходящих рёбер своих вершин
+        if (engine == "delta" && local_csr.num_vertices == 0 && load_error.empty()) {
+            local_csr = buildCsrFromDenseRows(reinterpret_cast<const W *>(local_storage.data()), my_num_vertices, total_nodes, my_first_vertex);
+            local_storage.release();
+        }
+    });
+    if (!load_error.empty()) {
+        if (rank == 0) {
+            std::cerr << "Ошибка чтения графа: " << load_error << "\n";
+        }
+        if (grid_2d) freeProcessGrid(grid);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (dist_bits == 32) {
+        // Сгенерированный граф ограничен --max-weight, для файла — наибольший вес по блокам всех процессов
+        int local_max_weight = generator.max_weight, max_weight = 0;
+        if (from_file) {
+            local_max_weight = engine == "delta" ? local_csr.maxWeight() : dispatchWeightType(weight_bytes, [&](auto tag) {
+                using W = decltype(tag);
+                return maxStoredWeight(reinterpret_cast<const W *>(local_storage.data()), local_storage.size() / sizeof(W));
+            });
+        }
+        MPI_Allreduce(&local_max_weight, &max_weight, 1, MPI_INT, MPI_MAX, comm);
+        if (reject_int_distances(max_weight)) {
+            if (grid_2d) freeProcessGrid(grid);
+            MPI_Finalize();
+            return 1;
         }
-    } else {
-        MPI_Recv(local_graph_matrix.data(), rows_per_proc * total_nodes, MPI_INT, 0, 0, comm, MPI_STATUS_IGNORE);
+    }
+
+    if (engine == "delta") {
+        if (delta <= 0) {
+            // Автоподбор как в последовательной версии: максимальный вес / средняя степень
+            int local_stats[2] = {local_csr.maxWeight(), local_csr.numEdges()};
+            int max_weight = 0;
+            long long local_edges = local_stats[1], total_edges = 0;
+            MPI_Allreduce(&local_stats[0], &max_weight, 1, MPI_INT, MPI_MAX, comm);
+            MPI_Allreduce(&local_edges, &total_edges, 1, MPI_LONG_LONG, MPI_SUM, comm);
+            long long avg_degree = std::max(1LL, total_edges / total_nodes);
+            delta = std::max(1, static_cast<int>(max_weight / avg_degree));
+        }
+    }
+
+    // Запуск параллельного Dijkstra по локальному блоку строк от source (target = -1 — все вершины)
+    SimdLevel dense_level = SimdLevel::Scalar;
+    RunProfile run_profile;
+    RunProfile *profile = profiling ? &run_profile : nullptr;
+    VertexPermutation permutation; // при --reorder: нумерация, в которой разбит граф (на всех процессах)
+    auto run_engine = [&](int source, int target) {
+        int settled = 0;
+        if (engine == "delta") {
+            if (!permutation.order.empty()) {
+                source = permutation.new_id[source];
+                if (target >= 0) target = permutation.new_id[target];
+            }
+            settled = dijkstra_mpi_delta(local_csr, local_dist.data(), local_pred.data(), partition, source, target, delta, comm, profile);
+        } else {
+            dispatchWeightType(weight_bytes, [&](auto w_tag) {
+                using W = decltype(w_tag);
+                dispatchDistType(dist_bits, [&](auto d_tag) {
+                    using D = decltype(d_tag);
+                    SimdKernels<W, D> kernels = selectSimdKernels<W, D>(simd_level);
+                    D *dist = nullptr;
+                    if constexpr (std::is_same<D, int>::value) dist = local_dist.data();
+                    else dist = local_dist64.data();
+                    const W *local_block = reinterpret_cast<const W *>(local_storage.data());
+                    dense_level = kernels.level;
+                    if (grid_2d) {
+                        settled = dijkstra_mpi_2d(local_block, grid, source, target, dist, local_pred.data(), kernels, num_threads, profile);
+                    } else if (minimal_comm) {
+                        settled = dijkstra_mpi_minimal(local_block, dist, local_pred.data(), partition, source, target, comm, kernels, num_threads, profile);
+                    } else if (packed) {
+                        settled = dijkstra_mpi(PackedRowBlock<W>{local_block, total_nodes, my_first_vertex}, dist, local_pred.data(), partition, source, target, comm, kernels, num_threads, profile);
+                    } else {
+                        settled = dijkstra_mpi(DenseRowBlock<W>{local_block, total_nodes, my_first_vertex}, dist, local_pred.data(), partition, source, target, comm, kernels, num_threads, profile);
+                    }
+                });
+            });
+        }
+        return settled;
+    };
+
+    // Сбор результатов на корневом процессе (массивы под весь граф выделяются при первом сборе)
+    // При --dist-bits=64 расстояния собираются в global_dist64, global_dist остаётся пустым
+    std::vector<int> global_dist, global_pred;
+    std::vector<std::int64_t> global_dist64;
+    const bool wide_dist = dist_bits == 64;
+    auto gather_results = [&]() {
+        if (rank == 0 && global_pred.empty()) {
+            if (wide_dist) global_dist64.resize(total_nodes);
+            else global_dist.resize(total_nodes);
+            global_pred.resize(total_nodes);
+        }
+        const void *send_dist_ptr = wide_dist ? static_cast<const void *>(local_dist64.data()) : local_dist.data();
+        void *recv_dist_ptr = rank != 0 ? nullptr : wide_dist ? static_cast<void *>(global_dist64.data()) : global_dist.data();
+        int* recv_pred_ptr = (rank == 0) ? global_pred.data() : nullptr;
+        const MPI_Datatype dist_type = wide_dist ? mpiDistType<std::int64_t>() : mpiDistType<int>();
+        if (grid_2d) {
+            // Столбцы решётки хранят одинаковые расстояния: собираем с первой строки решётки
+            if (grid.row == 0) {
+                std::vector<int> counts = grid.blocks.counts(), displs = grid.blocks.displs();
+                MPI_Gatherv(send_dist_ptr, my_num_vertices, dist_type, recv_dist_ptr, counts.data(), displs.data(), dist_type, 0, grid.row_comm);
+                MPI_Gatherv(local_pred.data(), my_num_vertices, MPI_INT, recv_pred_ptr, counts.data(), displs.data(), MPI_INT, 0, grid.row_comm);
+            }
+        } else {
+            // Блоки могут быть разного размера — MPI_Gatherv со смещениями из разбиения
+            std::vector<int> counts = partition.counts(), displs = partition.displs();
+            MPI_Gatherv(send_dist_ptr, my_num_vertices, dist_type, recv_dist_ptr, counts.data(), displs.data(), dist_type, 0, comm);
+            MPI_Gatherv(local_pred.data(), my_num_vertices, MPI_INT, recv_pred_ptr, counts.data(), displs.data(), MPI_INT, 0, comm);
+        }
+        // Результаты перенумерованного графа — в исходные номера вершин
+        if (rank == 0 && !permutation.order.empty()) restoreOriginalIds(permutation, global_dist.data(), global_pred.data());
+    };
+
+    // Перенумерация: сначала эталонный прогон по исходным блокам (для ускорения и сверки),
+    // затем граф переставляется и заново делится на блоки; время перестановки входит во время загрузки
+    double baseline_time = 0.0, ordering_time = 0.0;
+    std::vector<int> baseline_dist;
+    OrderingQuality quality_before, quality_after;
+    long long cut_before = 0, cut_after = 0, total_arcs = 0;
+    if (reorder != VertexOrder::None) {
+        if (!serve) {
+            RunProfile *saved_profile = profile;
+            profile = nullptr;
+            MPI_Barrier(comm);
+            double baseline_start = MPI_Wtime();
+            run_engine(start_vertex, target_vertex);
+            MPI_Barrier(comm);
+            baseline_time = MPI_Wtime() - baseline_start;
+            profile = saved_profile;
+            gather_results();
+            baseline_dist = global_dist;
+        }
+
+        long long local_cut = countCutArcs(local_csr, partition, rank), local_arcs = local_csr.numEdges();
+        MPI_Reduce(&local_cut, &cut_before, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+        MPI_Reduce(&local_arcs, &total_arcs, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+
+        double ordering_start = MPI_Wtime();
+        permutation = reorderCsrBlocksMpi(local_csr, partition, reorder, quality_before, quality_after, comm);
+        ordering_time = MPI_Wtime() - ordering_start;
+
+        local_cut = countCutArcs(local_csr, partition, rank);
+        MPI_Reduce(&local_cut, &cut_after, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    }
+
+    if (serve) {
+        // Процесс 0 принимает запросы и держит кэш; на промахе рассылает {команда, source, target},
+        // и все процессы считают запрос по уже загруженным блокам
+        enum ServerCommand { kServerSolve, kServerQuit };
+        int status = 0;
+        if (rank == 0) {
+            QueryChannel channel;
+            std::string error;
+            if (socket_path.empty()) {
+                channel.openStdio();
+            } else if (!channel.openSocket(socket_path, error)) {
+                std::cerr << "Ошибка сервера: " << error << "\n";
+                status = 1;
+            }
+            if (status == 0) {
+                std::fprintf(stderr, "Server ready: %d vertices, %d ranks x %d threads, load time %.6f s, cache %d trees, listening on %s\n",
+                             total_nodes, num_procs, num_threads, MPI_Wtime() - read_start_time, cache_size, channel.description().c_str());
+                runQueryServer(channel, total_nodes, static_cast<std::size_t>(cache_size),
+                               [&](int source, int target, ShortestPathTree &tree, std::string &) {
+                    int command[3] = {kServerSolve, source, target};
+                    MPI_Bcast(command, 3, MPI_INT, 0, comm);
+                    tree.settled = run_engine(source, target);
+                    gather_results();
+                    tree.dist.resize(total_nodes);
+                    tree.pred.assign(global_pred.begin(), global_pred.end());
+                    for (int v = 0; v < total_nodes; ++v) {
+                        if (wide_dist) tree.dist[v] = global_dist64[v] == distInfinity<std::int64_t>() ? -1 : global_dist64[v];
+                        else tree.dist[v] = global_dist[v] == INF ? -1 : global_dist[v];
+                    }
+                    return true;
+                });
+            }
+            int command[3] = {kServerQuit, 0, 0};
+            MPI_Bcast(command, 3, MPI_INT, 0, comm);
+        } else {
+            while (true) {
+                int command[3];
+                MPI_Bcast(command, 3, MPI_INT, 0, comm);
+                if (command[0] == kServerQuit) break;
+                run_engine(command[1], command[2]);
+                gather_results();
+            }
+        }
+        if (grid_2d) freeProcessGrid(grid);
+        MPI_Finalize();
+        return status;
     }
 
     // Сохраняем время
     MPI_Barrier(comm);
     double parallel_start_time = MPI_Wtime();
 
-    // Запуск параллельного Dijkstra по локальному блоку строк
-    dijkstra_mpi(local_graph_matrix.data(), local_dist.data(), local_pred.data(), total_nodes, rows_per_proc, 0, comm);
+    int settled = run_engine(start_vertex, target_vertex);
 
-    // Сохраняем время
-    MPI_Barrier(comm);
+    // Сохраняем время (ожидание на барьере — дисбаланс завершения)
+    {
+        PhaseTimer timer(profile, kPhaseWait);
+        MPI_Barrier(comm);
+    }
     double parallel_end_time = MPI_Wtime();
 
-    // Сбор результатов на корневом процессе
-    std::vector<int> global_dist, global_pred;
-    if (rank == 0) {
-        global_dist.resize(total_nodes);
-        global_pred.resize(total_nodes);
-    }
+    // С --output сбор нужен только для пути до цели и сверки перенумерованного прогона с эталоном
+    if (output_path.empty() || target_vertex >= 0 || !permutation.order.empty()) gather_results();
 
-    int* recv_dist_ptr = (rank == 0) ? global_dist.data() : nullptr;
-    int* recv_pred_ptr = (rank == 0) ? global_pred.data() : nullptr;
-    MPI_Gather(local_dist.data(), rows_per_proc, MPI_INT, recv_dist_ptr, rows_per_proc, MPI_INT, 0, comm);
-    MPI_Gather(local_pred.data(), rows_per_proc, MPI_INT, recv_pred_ptr, rows_per_proc, MPI_INT, 0, comm);
+    int status = 0;
+    double write_time = 0.0;
+    if (!output_path.empty()) {
+        // Перенумерованный результат каждый процесс переводит к исходным номерам своего отрезка;
+        // в 2D расстояния столбца решётки одинаковы у всех строк, пишет первая строка
+        int write_first = my_first_vertex, write_count = my_num_vertices;
+        const int *write_dist = local_dist.data(), *write_pred = local_pred.data();
+        std::vector<int> original_dist, original_pred;
+        if (!permutation.order.empty()) {
+            original_dist.resize(my_num_vertices);
+            original_pred.resize(my_num_vertices);
+            restoreOriginalIdsMpi(permutation, partition, local_dist.data(), local_pred.data(), original_dist.data(), original_pred.data(), comm);
+            write_dist = original_dist.data();
+            write_pred = original_pred.data();
+        } else if (grid_2d && grid.row != 0) {
+            write_count = 0;
+        }
+        double write_start = MPI_Wtime();
+        bool written = wide_dist ? writeResultFileMpi(output_path, total_nodes, start_vertex, target_vertex, write_first, write_count, local_dist64.data(), write_pred, comm)
+                                 : writeResultFileMpi(output_path, total_nodes, start_vertex, target_vertex, write_first, write_count, write_dist, write_pred, comm);
+        if (!written) {
+            if (rank == 0) std::cerr << "Ошибка записи результата в " << output_path << "\n";
+            status = 1;
+        }
+        write_time = MPI_Wtime() - write_start;
+    }
+    if (grid_2d) freeProcessGrid(grid);
+    unsigned long long local_bytes = local_storage.size(), max_block_bytes = 0;
+    MPI_Reduce(&local_bytes, &max_block_bytes, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, 0, comm);
 
     // ========================================================================================
     // Вывод
     // ========================================================================================
     if (rank == 0) {
         std::printf("total_nodes: %d \n", total_nodes);
+        const BlockPartition &blocks = grid_2d ? grid.blocks : partition;
+        int min_block = blocks.base, max_block = blocks.base + (blocks.extra > 0 ? 1 : 0);
+        if (grid_2d) {
+            std::printf("Partition: 2d %dx%d grid, blocks of %d..%d vertices\n", grid_side, grid_side, min_block, max_block);
+        } else {
+            std::printf("Partition: 1d, %d blocks of %d..%d vertices\n", num_procs, min_block, max_block);
+        }
+        std::printf("Layout: %d ranks x %d threads\n", num_procs, num_threads);
+        if (!local_storage.empty()) std::printf("Memory: rank 0 matrix block %s\n", local_storage.report().describe().c_str());
+        std::printf("Memory: rank 0 dist/pred (each) %s\n", local_dist.report().describe().c_str());
+        if (engine == "delta") {
+            std::printf("Engine: delta-stepping, delta: %d\n", delta);
+        } else {
+            const char *weight_name = dispatchWeightType(weight_bytes, [](auto tag) { return weightTypeName<decltype(tag)>(); });
+            std::printf("Comm mode: %s, simd: %s, weights: %s, dist: %d-bit\n", comm_mode.c_str(), simdLevelName(dense_level), weight_name, dist_bits);
+            std::printf("Storage: %s, matrix block: up to %.1f MB per rank\n", storage.c_str(), max_block_bytes / 1e6);
+        }
+        if (reorder != VertexOrder::None) {
+            std::printf("Reorder: %s, cut arcs %lld -> %lld of %lld, bandwidth %d -> %d, ordering time %.6f s\n", vertexOrderName(reorder),
+                        cut_before, cut_after, total_arcs, quality_before.bandwidth, quality_after.bandwidth, ordering_time);
+        }
         std::printf("Compute time: %.6f seconds\n", parallel_end_time - parallel_start_time);
-        std::printf("Matrix load time: %.6f s\n\n", parallel_start_time - read_start_time);
+        std::printf("Matrix load time: %.6f s\n\n", parallel_start_time - read_start_time - baseline_time);
+        if (target_vertex >= 0) {
+            long long target_dist = wide_dist ? (global_dist64[target_vertex] == distInfinity<std::int64_t>() ? -1 : global_dist64[target_vertex])
+                                              : (global_dist[target_vertex] == INF ? -1 : global_dist[target_vertex]);
+            printPathQuery(start_vertex, target_vertex, target_dist, settled, total_nodes,
+                           reconstructPath(global_pred.data(), total_nodes, start_vertex, target_vertex));
+        }
+        if (!output_path.empty() && status == 0) {
+            std::printf("Result written to %s (%.1f MB) in %.6f s\n", output_path.c_str(),
+                        resultFileSize(makeResultHeader(total_nodes, start_vertex, target_vertex, dist_bits / 8)) / 1e6, write_time);
+        }
     }
 
-    // Для вывода матрицы смежности графа — раскомментировать:
-    // if (rank == 0) {
-    //     std::cout << "Graph adjacency matrix:\n";
-    //     for (int row = 0; row < total_nodes; ++row) {
-    //         for (int col = 0; col < total_nodes; ++col) {
-    //             if (graph_matrix[row * total_nodes + col] == INF)
-    //                 std::cout << "INF ";
-    //             else
-    //                 std::cout << graph_matrix[row * total_nodes + col] << " ";
-    //         }
-    //         std::cout << "\n";
-    //     }
-    //     std::cout << "\n";
-    // }
+    if (reorder != VertexOrder::None && rank == 0) {
+        // Запрос с целью сверяет только её расстояние: остальные вершины могли остаться необработанными
+        double compute_time = parallel_end_time - parallel_start_time;
+        bool match = target_vertex >= 0 ? global_dist[target_vertex] == baseline_dist[target_vertex] : global_dist == baseline_dist;
+        std::printf("Baseline (original order): %.6f s, speedup %.2fx, check: %s\n\n", baseline_time,
+                    compute_time > 0 ? baseline_time / compute_time : 0.0, match ? "OK" : "MISMATCH");
+        if (!match) status = 1;
+    }
+    if (profiling && !reportProfileMpi(run_profile, comm, trace_path)) {
+        std::fprintf(stderr, "Ошибка записи трассы профиля в %s\n", trace_path.c_str());
+        status = 1;
+    }
 
     // Для вывода путей — раскомментировать:
     // if (rank == 0) {
-    //     std::cout << "The distance from the vertex is 0:\n";
+    //     std::cout << "The distance from the vertex is " << start_vertex << ":\n";
     //     for (int v = 0; v < total_nodes; ++v) {
     //         if (global_dist[v] == INF)
     //             std::cout << v << ": INF\n";
@@ -256,5 +1225,5 @@ int main(int argc, char *argv[]) {
     // }
 
     MPI_Finalize();
-    return 0;
+    return status;
 }
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <mpi.h>
+#include "../common/active_set.hpp"
+#include "../common/graph.hpp"
+#include "../common/simd_kernels.hpp"
+#include "../common/thread_team.hpp"
+#include "dist_type_mpi.hpp"
+#include "partition.hpp"
+#include "profile_mpi.hpp"
+
+/**
+ * @brief Квадратная решётка процессов q x q для 2D-разбиения матрицы смежности.
+ *
+ * Процесс (row, col) хранит блок матрицы: строки блока row x столбцы блока col
+ * (блоки вершин задаёт blocks = BlockPartition(n, q)). row_comm объединяет процессы
+ * одной строки решётки (ранг в нём = col), col_comm — одного столбца (ранг = row).
+ */
+struct ProcessGrid {
+    int side = 1;
+    int row = 0;
+    int col = 0;
+    MPI_Comm row_comm = MPI_COMM_NULL;
+    MPI_Comm col_comm = MPI_COMM_NULL;
+    BlockPartition blocks;
+};
+
+/**
+ * @brief Сторона квадратной решётки для num_procs процессов.
+ * @return 0, если num_procs не является полным квадратом.
+ */
+inline int gridSide(int num_procs) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= num_procs) ++side;
+    return side * side == num_procs ? side : 0;
+}
+
+/**
+ * @brief Построение решётки side x side над comm (коллективная операция).
+ */
+inline ProcessGrid createProcessGrid(int countVertices, int side, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    ProcessGrid grid;
+    grid.side = side;
+    grid.row = rank / side;
+    grid.col = rank % side;
+    grid.blocks = BlockPartition(countVertices, side);
+    MPI_Comm_split(comm, grid.row, grid.col, &grid.row_comm);
+    MPI_Comm_split(comm, grid.col, grid.row, &grid.col_comm);
+    return grid;
+}
+
+inline void freeProcessGrid(ProcessGrid &grid) {
+    if (grid.row_comm != MPI_COMM_NULL) MPI_Comm_free(&grid.row_comm);
+    if (grid.col_comm != MPI_COMM_NULL) MPI_Comm_free(&grid.col_comm);
+}
+
+/**
+ * @brief Параллельный Дейкстра с 2D-разбиением матрицы на решётке q x q процессов.
+ *
+ * Расстояния вершин блока столбцов col хранятся (одинаково) у всех процессов столбца решётки.
+ * За итерацию: MPI_MINLOC-редукция внутри строки решётки (q процессов) — каждая строка
+ * получает один и тот же глобальный минимум u; затем процессы строки-владельца u рассылают
+ * по своим столбцам решётки отрезок строки u длиной n/q. Объём рассылки на процесс
+ * в q раз меньше, чем у 1D-схемы --comm=bcast, а коллективы идут по q, а не по p процессам.
+ * Потоки держат сжатые списки непосещённых вершин своих отрезков блока столбцов (ActiveSet).
+ *
+ * @tparam W Тип веса матрицы (uint8_t, uint16_t или int).
+ * @tparam D Тип расстояния (int или std::int64_t).
+ * @param local_block Блок матрицы: local_block[r * num_cols + c] = w(first_row + r, first_col + c).
+ * @param grid Решётка процессов (createProcessGrid).
+ * @param start Начальная вершина (глобальный индекс).
+ * @param target Целевая вершина (-1 — все вершины): цикл завершается, как только MINLOC выбирает её.
+ * @param col_dist [out] Расстояния вершин своего блока столбцов (размер = grid.blocks.size(grid.col)).
+ * @param col_pred [out] Предки вершин своего блока столбцов.
+ * @param kernels Ядра поиска минимума и релаксации (selectSimdKernels).
+ * @param num_threads Число потоков внутри процесса (MPI вызывает только поток 0).
+ * @param profile [out] Профиль запуска (nullptr — без профилирования); фазы замеряет поток 0.
+ * @return Число посещённых вершин (одинаково на всех процессах).
+ */
+template <typename W, typename D>
+int dijkstra_mpi_2d(const W *local_block, const ProcessGrid &grid, int start, int target, D *col_dist, int *col_pred, const SimdKernels<W, D> &kernels, int num_threads, RunProfile *profile = nullptr) {
+    const int total_nodes = grid.blocks.total;
+    const int first_row = grid.blocks.begin(grid.row);
+    const int first_col = grid.blocks.begin(grid.col);
+    const int num_cols = grid.blocks.size(grid.col);
+
+    MinLocPair<D> global_min_pair{distInfinity<D>(), -1}; // {min_dist, global_index}
+    MinLocPair<D> local_min_pair{distInfinity<D>(), -1};
+    std::vector<W> u_segment(num_cols);
+
+    for (int i = 0; i < num_cols; ++i) {
+        col_dist[i] = distInfinity<D>();
+        col_pred[i] = -1;
+    }
+    if (start >= first_col && start < first_col + num_cols) {
+        col_dist[start - first_col] = 0;
+    }
+
+    num_threads = std::max(1, std::min(num_threads, num_cols));
+    const BlockPartition slices(num_cols, num_threads);
+    std::vector<ThreadArgmin<D>> thread_min(num_threads);
+    SpinBarrier barrier(num_threads);
+    int settled_local = 0;
+    int settled = 0;
+    std::vector<std::uint64_t> thread_updates(num_threads, 0);
+
+    runThreadTeam(num_threads, [&](int t) {
+        const int lo = slices.begin(t), len = slices.size(t);
+        RunProfile *timing = t == 0 ? profile : nullptr;
+        std::uint64_t updates = 0;
+        ActiveSet<D> active;
+        active.assign(col_dist + lo, len);
+
+        for (int iteration = 0; iteration < total_nodes; ++iteration) {
+            int best = -1;
+            {
+                PhaseTimer timer(timing, kPhaseSelect);
+                best = kernels.argmin_active(active.dist(), active.size());
+                thread_min[t] = best == -1 ? ThreadArgmin<D>{} : ThreadArgmin<D>{active.dist()[best], lo + active.vertex(best)};
+            }
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
+            }
+
+            if (t == 0) {
+                ThreadArgmin<D> local_best = reduceThreadArgmin(thread_min);
+                local_min_pair = {local_best.dist, local_best.index == -1 ? -1 : first_col + local_best.index};
+
+                // Строка решётки покрывает все блоки столбцов, т.е. все вершины графа
+                profileBarrier(profile, grid.row_comm);
+                {
+                    PhaseTimer timer(profile, kPhaseReduce);
+                    MPI_Allreduce(&local_min_pair, &global_min_pair, 1, MinLocPair<D>::type(), MPI_MINLOC, grid.row_comm);
+                }
+
+                int u = global_min_pair.index;
+                if (u != -1) {
+                    if (u >= first_col && u < first_col + num_cols) ++settled_local;
+                    ++settled;
+                }
+                if (u != -1 && u != target) {
+                    // Отрезок строки u в своём блоке столбцов хранит процесс строки решётки owner_row
+                    int owner_row = grid.blocks.owner(u);
+                    if (grid.row == owner_row) {
+                        std::size_t local_u_idx = static_cast<std::size_t>(u - first_row);
+                        std::memcpy(u_segment.data(), &local_block[local_u_idx * num_cols], num_cols * sizeof(W));
+                    }
+                    PhaseTimer timer(profile, kPhaseBcast);
+                    MPI_Bcast(u_segment.data(), num_cols * static_cast<int>(sizeof(W)), MPI_BYTE, owner_row, grid.col_comm);
+                }
+                if (profile) {
+                    profile->bytes += 2 * sizeof(local_min_pair);
+                    if (u != -1 && u != target) {
+                        profile->bytes += static_cast<std::uint64_t>(num_cols) * sizeof(W);
+                        profile->relax_attempted += num_cols - settled_local;
+                        ++profile->iterations;
+                    }
+                }
+            }
+            {
+                PhaseTimer timer(timing, kPhaseWait);
+                barrier.wait();
+            }
+
+            // Процессы столбца решётки хранят одинаковые расстояния и выбирают одного кандидата
+            int u_global_idx = global_min_pair.index;
+            if (best != -1 && u_global_idx == first_col + lo + active.vertex(best)) active.settle(best, col_dist + lo);
+            if (u_global_idx == -1 || u_global_idx == target) break;
+
+            PhaseTimer timer(timing, kPhaseRelax);
+            updates += kernels.relax_active(u_segment.data() + lo, static_cast<D>(global_min_pair.dist), u_global_idx, active.ids(), active.dist(), col_pred + lo, active.size());
+        }
+        active.flush(col_dist + lo);
+        thread_updates[t] = updates;
+    });
+    if (profile) {
+        for (std::uint64_t updates : thread_updates) profile->relax_successful += updates;
+    }
+    return settled;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <mpi.h>
+
+/**
+ * Расстояния MPI-движков: int (32 бита) или std::int64_t (--dist-bits=64).
+ *
+ * MinLocPair<D> — пара {расстояние, вершина} с раскладкой встроенного парного типа MPI,
+ * поэтому MPI_MINLOC работает без пользовательской операции: MPI_2INT для int,
+ * MPI_LONG_INT ({long, int}) для std::int64_t.
+ */
+template <typename D>
+struct MinLocPair;
+
+template <>
+struct MinLocPair<int> {
+    int dist;
+    int index;
+    static MPI_Datatype type() { return MPI_2INT; }
+};
+
+static_assert(sizeof(long) == sizeof(std::int64_t), "MPI_LONG_INT requires 64-bit long");
+
+template <>
+struct MinLocPair<std::int64_t> {
+    long dist;
+    int index;
+    static MPI_Datatype type() { return MPI_LONG_INT; }
+};
+
+/**
+ * @brief Тип MPI для массивов расстояний D.
+ */
+template <typename D>
+inline MPI_Datatype mpiDistType() {
+    return sizeof(D) == sizeof(std::int64_t) ? MPI_INT64_T : MPI_INT;
+}
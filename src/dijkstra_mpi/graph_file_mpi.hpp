@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "../common/graph_file.hpp"
+#include "../common/row_block.hpp"
+
+/**
+ * @brief Открытие файла графа всеми процессами и коллективное чтение заголовка.
+ * @return false (на всех процессах), если файл не открылся или заголовок некорректен.
+ */
+inline bool openGraphFileMpi(const std::string &path, MPI_File &fh, GraphFileHeader &header, std::string &error, MPI_Comm comm) {
+    if (MPI_File_open(comm, path.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    if (!validateGraphHeader(header, error)) {
+        MPI_File_close(&fh);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Коллективное чтение блока строк [first_row, first_row + num_rows) плотной матрицы.
+ *
+ * Каждый процесс читает только свой участок файла (MPI_File_read_at_all). Если ширина веса
+ * файла совпадает с W, чтение идёт прямо в out, иначе веса преобразуются.
+ * @param out [out] num_rows * n весов.
+ */
+template <typename W>
+inline void readDenseRowBlockMpi(MPI_File fh, const GraphFileHeader &header, int first_row, int num_rows, W *out) {
+    const std::uint64_t n = header.num_vertices;
+    const std::uint64_t row_bytes = n * header.weight_bytes;
+
+    MPI_Datatype row_type;
+    MPI_Type_contiguous(static_cast<int>(row_bytes), MPI_BYTE, &row_type);
+    MPI_Type_commit(&row_type);
+
+    const bool direct = header.weight_bytes == sizeof(W);
+    std::vector<std::uint8_t> buffer(direct ? 0 : row_bytes * num_rows);
+    void *target = direct ? static_cast<void *>(out) : buffer.data();
+    MPI_Offset offset = static_cast<MPI_Offset>(header.payload_offset + row_bytes * first_row);
+    MPI_File_read_at_all(fh, offset, target, num_rows, row_type, MPI_STATUS_IGNORE);
+    MPI_Type_free(&row_type);
+
+    if (!direct) widenWeights(buffer.data(), static_cast<std::size_t>(n) * num_rows, header.weight_bytes, out);
+}
+
+/**
+ * @brief Коллективное чтение блока [first_row, first_row + num_rows) x [first_col, first_col + num_cols)
+ * плотной матрицы: out[r * num_cols + c] = w(first_row + r, first_col + c).
+ *
+ * Вид файла задаётся подмассивом (MPI_Type_create_subarray), так что процесс читает
+ * только свой прямоугольник матрицы.
+ */
+template <typename W>
+inline void readDenseBlockMpi(MPI_File fh, const GraphFileHeader &header, int first_row, int num_rows, int first_col, int num_cols, W *out) {
+    const int n = static_cast<int>(header.num_vertices);
+    const int wb = static_cast<int>(header.weight_bytes);
+
+    int sizes[2] = {n, n * wb};
+    int subsizes[2] = {num_rows, num_cols * wb};
+    int starts[2] = {first_row, first_col * wb};
+    MPI_Datatype file_type, row_type;
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_BYTE, &file_type);
+    MPI_Type_commit(&file_type);
+    MPI_Type_contiguous(num_cols * wb, MPI_BYTE, &row_type);
+    MPI_Type_commit(&row_type);
+
+    const bool direct = header.weight_bytes == sizeof(W);
+    std::vector<std::uint8_t> buffer(direct ? 0 : static_cast<std::size_t>(num_rows) * num_cols * wb);
+    void *target = direct ? static_cast<void *>(out) : buffer.data();
+    MPI_File_set_view(fh, static_cast<MPI_Offset>(header.payload_offset), MPI_BYTE, file_type, "native", MPI_INFO_NULL);
+    MPI_File_read_all(fh, target, num_rows, row_type, MPI_STATUS_IGNORE);
+    MPI_File_set_view(fh, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+
+    MPI_Type_free(&row_type);
+    MPI_Type_free(&file_type);
+
+    if (!direct) widenWeights(buffer.data(), static_cast<std::size_t>(num_rows) * num_cols, header.weight_bytes, out);
+}
+
+/**
+ * @brief Коллективное чтение плотного симметричного файла сразу в упакованную раскладку
+ * (PackedRowBlock) для вершин [first_vertex, first_vertex + count).
+ *
+ * Полные строки полос плиток читаются порциями, так что временный буфер не превышает
+ * ~64 МБ и полный блок строк в памяти не появляется. Число порций выравнивается по всем
+ * процессам comm: коллективное чтение вызывают все (лишние вызовы — пустые).
+ * @param out [out] PackedRowBlock<W>::blockSize(n, first_vertex, count) весов.
+ */
+template <typename W>
+inline void readPackedRowBlockMpi(MPI_File fh, const GraphFileHeader &header, int first_vertex, int count, W *out, MPI_Comm comm) {
+    constexpr int B = PackedRowBlock<W>::kTile;
+    const int n = static_cast<int>(header.num_vertices);
+    const int first_tile_row = PackedRowBlock<W>::firstTileRow(first_vertex);
+    const int num_tile_rows = PackedRowBlock<W>::numTileRows(first_vertex, count);
+    const int chunk_tile_rows = static_cast<int>(std::max<std::uint64_t>(1, (std::uint64_t(64) << 20) / (std::uint64_t(n) * B * sizeof(W))));
+
+    int num_chunks = (num_tile_rows + chunk_tile_rows - 1) / chunk_tile_rows, max_chunks = 0;
+    MPI_Allreduce(&num_chunks, &max_chunks, 1, MPI_INT, MPI_MAX, comm);
+
+    std::vector<W> chunk(static_cast<std::size_t>(std::min(chunk_tile_rows, num_tile_rows)) * B * n);
+    for (int c = 0; c < max_chunks; ++c) {
+        const int tile_row = first_tile_row + std::min(c * chunk_tile_rows, num_tile_rows);
+        const int tiles = std::max(0, std::min(chunk_tile_rows, num_tile_rows - c * chunk_tile_rows));
+        const int first_row = std::min(tile_row * B, n);
+        const int num_rows = std::min((tile_row + tiles) * B, n) - first_row;
+        readDenseRowBlockMpi(fh, header, first_row, num_rows, chunk.data());
+        if (tiles > 0) packDenseRows(chunk.data(), n, tile_row, tiles, out + (tile_row - first_tile_row) * PackedRowBlock<W>::tileRowSize(n));
+    }
+}
+
+/**
+ * @brief Коллективное чтение строк [first_row, first_row + num_rows) CSR-файла в локальный CSR.
+ *
+ * Строки нумеруются локально с нуля, номера столбцов остаются глобальными. Каждый процесс
+ * проверяет свои смещения и столбцы (validateCsrOffsets, validateCsrColumns) до построения
+ * CSR, итог сводится по comm: при ошибке false возвращают все процессы, а error у всех —
+ * описание от процесса с наименьшим номером среди нашедших ошибку.
+ * @param error [out] Описание ошибки.
+ */
+inline bool readCsrRowBlockMpi(MPI_File fh, const GraphFileHeader &header, int first_row, int num_rows, CsrGraph &graph,
+                               std::string &error, MPI_Comm comm) {
+    CsrSections sections = csrSections(header);
+    auto all_ok = [&](bool ok) {
+        int rank = 0, num_procs = 1;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &num_procs);
+        int local = ok ? num_procs : rank, reporter = 0;
+        MPI_Allreduce(&local, &reporter, 1, MPI_INT, MPI_MIN, comm);
+        if (reporter == num_procs) return true;
+
+        int length = static_cast<int>(error.size());
+        MPI_Bcast(&length, 1, MPI_INT, reporter, comm);
+        error.resize(length);
+        MPI_Bcast(&error[0], length, MPI_CHAR, reporter, comm);
+        return false;
+    };
+
+    std::vector<std::uint64_t> offsets(num_rows + 1);
+    MPI_File_read_at_all(fh, static_cast<MPI_Offset>(sections.offsets + sizeof(std::uint64_t) * first_row),
+                         offsets.data(), (num_rows + 1) * static_cast<int>(sizeof(std::uint64_t)), MPI_BYTE, MPI_STATUS_IGNORE);
+    // Смещения проверяются до чтения столбцов: от них зависят размеры и позиции чтения
+    if (!all_ok(validateCsrOffsets(header, first_row, offsets.data(), num_rows, error))) return false;
+
+    const std::uint64_t first_edge = offsets.front();
+    const int num_edges = static_cast<int>(offsets.back() - first_edge);
+
+    std::vector<std::uint32_t> columns(num_edges);
+    MPI_File_read_at_all(fh, static_cast<MPI_Offset>(sections.columns + sizeof(std::uint32_t) * first_edge),
+                         columns.data(), num_edges * static_cast<int>(sizeof(std::uint32_t)), MPI_BYTE, MPI_STATUS_IGNORE);
+    if (!all_ok(validateCsrColumns(header, first_edge, columns.data(), columns.size(), error))) return false;
+
+    graph = CsrGraph();
+    graph.num_vertices = num_rows;
+    graph.row_offsets.resize(num_rows + 1);
+    for (int r = 0; r <= num_rows; ++r) graph.row_offsets[r] = static_cast<int>(offsets[r] - first_edge);
+    graph.col_indices.assign(columns.begin(), columns.end());
+
+    std::vector<std::uint8_t> weights(static_cast<std::size_t>(num_edges) * header.weight_bytes);
+    MPI_File_read_at_all(fh, static_cast<MPI_Offset>(sections.weights + header.weight_bytes * first_edge),
+                         weights.data(), static_cast<int>(weights.size()), MPI_BYTE, MPI_STATUS_IGNORE);
+    graph.weights.resize(num_edges);
+    widenWeights(weights.data(), num_edges, header.weight_bytes, graph.weights.data());
+
+    return true;
+}
+
+/**
+ * @brief Плотный блок строк типа W по локальному CSR: код отсутствия ребра для пустых ячеек, 0 на диагонали.
+ * @param transpose false — строки (out[r * n + v] = w(r, v)),
+ *                  true — столбцы для симметричного графа (out[v * num_rows + r] = w(r, v) = w(v, r)).
+ */
+template <typename W>
+inline void densifyCsrRows(const CsrGraph &rows, int countVertices, int first_row, bool transpose, W *out) {
+    const int n = countVertices;
+    const int num_rows = rows.num_vertices;
+    std::fill(out, out + static_cast<std::size_t>(num_rows) * n, WeightTraits<W>::kNoEdge);
+
+    for (int r = 0; r < num_rows; ++r) {
+        int u = first_row + r;
+        std::size_t diag = transpose ? static_cast<std::size_t>(u) * num_rows + r : static_cast<std::size_t>(r) * n + u;
+        out[diag] = 0;
+
+        for (int e = rows.row_offsets[r]; e < rows.row_offsets[r + 1]; ++e) {
+            int v = rows.col_indices[e];
+            std::size_t cell = transpose ? static_cast<std::size_t>(v) * num_rows + r : static_cast<std::size_t>(r) * n + v;
+            W w = encodeWeight<W>(rows.weights[e]);
+            if (w < out[cell]) out[cell] = w;
+        }
+    }
+}
+
+/**
+ * @brief Плотный блок типа W по локальному CSR, только столбцы [first_col, first_col + num_cols):
+ * out[r * num_cols + c] = w(first_row + r, first_col + c) (для 2D-разбиения).
+ */
+template <typename W>
+inline void densifyCsrBlock(const CsrGraph &rows, int first_row, int first_col, int num_cols, W *out) {
+    const int num_rows = rows.num_vertices;
+    std::fill(out, out + static_cast<std::size_t>(num_rows) * num_cols, WeightTraits<W>::kNoEdge);
+
+    for (int r = 0; r < num_rows; ++r) {
+        W *row = out + static_cast<std::size_t>(r) * num_cols;
+        int diag = first_row + r - first_col;
+        if (diag >= 0 && diag < num_cols) row[diag] = 0;
+
+        for (int e = rows.row_offsets[r]; e < rows.row_offsets[r + 1]; ++e) {
+            int c = rows.col_indices[e] - first_col;
+            if (c < 0 || c >= num_cols) continue;
+            W w = encodeWeight<W>(rows.weights[e]);
+            if (w < row[c]) row[c] = w;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief Разбиение вершин [0, n) на parts блоков подряд идущих вершин.
+ *
+ * Размеры блоков отличаются не более чем на единицу: первые n % parts блоков
+ * на одну вершину больше. Число процессов не обязано делить n.
+ * Владелец вершины вычисляется по формуле за O(1), без таблицы размера n.
+ */
+struct BlockPartition {
+    int total = 0;
+    int parts = 1;
+    int base = 0;   // размер коротких блоков
+    int extra = 0;  // число длинных блоков (base + 1)
+
+    BlockPartition() = default;
+    BlockPartition(int countVertices, int num_parts)
+        : total(countVertices), parts(num_parts), base(countVertices / num_parts), extra(countVertices % num_parts) {}
+
+    int begin(int part) const { return part * base + std::min(part, extra); }
+    int size(int part) const { return base + (part < extra ? 1 : 0); }
+    int end(int part) const { return begin(part) + size(part); }
+
+    /**
+     * @brief Номер блока, которому принадлежит вершина v.
+     */
+    int owner(int v) const {
+        const int long_span = extra * (base + 1);
+        if (v < long_span) return v / (base + 1);
+        return extra + (v - long_span) / base;
+    }
+
+    /**
+     * @brief Размеры и смещения блоков (для MPI_Gatherv / MPI_Scatterv).
+     */
+    std::vector<int> counts() const {
+        std::vector<int> result(parts);
+        for (int p = 0; p < parts; ++p) result[p] = size(p);
+        return result;
+    }
+    std::vector<int> displs() const {
+        std::vector<int> result(parts);
+        for (int p = 0; p < parts; ++p) result[p] = begin(p);
+        return result;
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "../common/profile.hpp"
+
+/**
+ * @brief Барьер только при профилировании: время ожидания отстающих процессов
+ * уходит в фазу wait и не смешивается со временем следующей коллективной операции.
+ */
+inline void profileBarrier(RunProfile *profile, MPI_Comm comm) {
+    if (!profile) return;
+    PhaseTimer timer(profile, kPhaseWait);
+    MPI_Barrier(comm);
+}
+
+namespace profile_mpi_detail {
+
+constexpr int kValueCount = kPhaseCount + 4;
+
+inline void packProfile(const RunProfile &profile, double *values) {
+    for (int phase = 0; phase < kPhaseCount; ++phase) values[phase] = profile.phase_seconds[phase];
+    values[kPhaseCount + 0] = static_cast<double>(profile.bytes);
+    values[kPhaseCount + 1] = static_cast<double>(profile.relax_attempted);
+    values[kPhaseCount + 2] = static_cast<double>(profile.relax_successful);
+    values[kPhaseCount + 3] = static_cast<double>(profile.iterations);
+}
+
+} // namespace profile_mpi_detail
+
+/**
+ * @brief Сведение профилей всех процессов в отчёт min / avg / max на процессе 0 (коллективная операция).
+ * @param trace_path Файл CSV с показателями каждого процесса (пустая строка — не сохранять).
+ * @return false на процессе 0, если файл трассы не записался.
+ */
+inline bool reportProfileMpi(const RunProfile &profile, MPI_Comm comm, const std::string &trace_path) {
+    using namespace profile_mpi_detail;
+
+    int rank = 0, num_procs = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_procs);
+
+    double values[kValueCount], min_values[kValueCount], max_values[kValueCount], sum_values[kValueCount];
+    packProfile(profile, values);
+    MPI_Reduce(values, min_values, kValueCount, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(values, max_values, kValueCount, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(values, sum_values, kValueCount, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    std::vector<double> all_values;
+    if (!trace_path.empty()) {
+        if (rank == 0) all_values.resize(static_cast<std::size_t>(num_procs) * kValueCount);
+        MPI_Gather(values, kValueCount, MPI_DOUBLE, all_values.data(), kValueCount, MPI_DOUBLE, 0, comm);
+    }
+    if (rank != 0) return true;
+
+    std::printf("Profile (min / avg / max over %d ranks):\n", num_procs);
+    for (int k = 0; k < kValueCount; ++k) {
+        const char *name = k < kPhaseCount ? profilePhaseName(k)
+                         : k == kPhaseCount ? "bytes" : k == kPhaseCount + 1 ? "attempted"
+                         : k == kPhaseCount + 2 ? "successful" : "iterations";
+        const char *format = k < kPhaseCount ? "  %-10s %.6f / %.6f / %.6f s\n" : "  %-10s %.0f / %.0f / %.0f\n";
+        std::printf(format, name, min_values[k], sum_values[k] / num_procs, max_values[k]);
+    }
+    std::printf("\n");
+
+    if (trace_path.empty()) return true;
+    std::FILE *trace = std::fopen(trace_path.c_str(), "w");
+    if (!trace) return false;
+    std::fprintf(trace, "rank");
+    for (int phase = 0; phase < kPhaseCount; ++phase) std::fprintf(trace, ",%s_s", profilePhaseName(phase));
+    std::fprintf(trace, ",bytes,relax_attempted,relax_successful,iterations\n");
+    for (int r = 0; r < num_procs; ++r) {
+        const double *row = &all_values[static_cast<std::size_t>(r) * kValueCount];
+        std::fprintf(trace, "%d", r);
+        for (int phase = 0; phase < kPhaseCount; ++phase) std::fprintf(trace, ",%.9f", row[phase]);
+        std::fprintf(trace, ",%.0f,%.0f,%.0f,%.0f\n", row[kPhaseCount], row[kPhaseCount + 1], row[kPhaseCount + 2], row[kPhaseCount + 3]);
+    }
+    bool ok = std::fclose(trace) == 0;
+    if (ok) std::printf("Profile trace written to %s\n", trace_path.c_str());
+    return ok;
+}
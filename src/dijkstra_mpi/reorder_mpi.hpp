@@ -0,0 +1,162 @@
+#pragma once
+
+#include <numeric>
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "../common/reorder.hpp"
+#include "delta_stepping_mpi.hpp"
+#include "partition.hpp"
+
+/**
+ * @brief Число дуг локального блока строк, ведущих в вершины других процессов.
+ *
+ * Каждая такая дуга delta-stepping — запрос релаксации, пересылаемый через MPI_Alltoallv.
+ */
+inline long long countCutArcs(const CsrGraph &local_rows, const BlockPartition &partition, int rank) {
+    long long cut = 0;
+    for (int col : local_rows.col_indices) {
+        if (partition.owner(col) != rank) ++cut;
+    }
+    return cut;
+}
+
+/**
+ * @brief Сбор блоков строк CSR всех процессов в полный граф на процессе 0 (коллективная операция).
+ * @return Полный граф на процессе 0, пустой граф на остальных.
+ */
+inline CsrGraph gatherCsrBlocks(const CsrGraph &local_rows, const BlockPartition &partition, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    std::vector<int> degrees(local_rows.num_vertices);
+    for (int r = 0; r < local_rows.num_vertices; ++r) degrees[r] = local_rows.row_offsets[r + 1] - local_rows.row_offsets[r];
+    int local_edges = local_rows.numEdges();
+
+    CsrGraph graph;
+    std::vector<int> all_degrees, edge_counts, edge_displs;
+    if (rank == 0) {
+        graph.num_vertices = partition.total;
+        all_degrees.resize(partition.total);
+        edge_counts.resize(partition.parts);
+        edge_displs.resize(partition.parts);
+    }
+    std::vector<int> counts = partition.counts(), displs = partition.displs();
+    MPI_Gatherv(degrees.data(), local_rows.num_vertices, MPI_INT, all_degrees.data(), counts.data(), displs.data(), MPI_INT, 0, comm);
+    MPI_Gather(&local_edges, 1, MPI_INT, edge_counts.data(), 1, MPI_INT, 0, comm);
+
+    if (rank == 0) {
+        graph.row_offsets.assign(partition.total + 1, 0);
+        std::partial_sum(all_degrees.begin(), all_degrees.end(), graph.row_offsets.begin() + 1);
+        for (int p = 0; p < partition.parts; ++p) edge_displs[p] = graph.row_offsets[partition.begin(p)];
+        graph.col_indices.resize(graph.row_offsets.back());
+        graph.weights.resize(graph.row_offsets.back());
+    }
+    MPI_Gatherv(local_rows.col_indices.data(), local_edges, MPI_INT, graph.col_indices.data(), edge_counts.data(), edge_displs.data(), MPI_INT, 0, comm);
+    MPI_Gatherv(local_rows.weights.data(), local_edges, MPI_INT, graph.weights.data(), edge_counts.data(), edge_displs.data(), MPI_INT, 0, comm);
+    return graph;
+}
+
+/**
+ * @brief Раздача полного графа процесса 0 блоками строк по разбиению (коллективная операция).
+ * @param graph Полный граф (используется только на процессе 0).
+ * @return Локальный блок строк: номера строк локальные, номера столбцов глобальные.
+ */
+inline CsrGraph scatterCsrBlocks(const CsrGraph &graph, const BlockPartition &partition, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    std::vector<int> all_degrees, edge_counts, edge_displs;
+    if (rank == 0) {
+        all_degrees.resize(partition.total);
+        edge_counts.resize(partition.parts);
+        edge_displs.resize(partition.parts);
+        for (int v = 0; v < partition.total; ++v) all_degrees[v] = graph.row_offsets[v + 1] - graph.row_offsets[v];
+        for (int p = 0; p < partition.parts; ++p) {
+            edge_displs[p] = graph.row_offsets[partition.begin(p)];
+            edge_counts[p] = graph.row_offsets[partition.end(p)] - edge_displs[p];
+        }
+    }
+
+    CsrGraph local_rows;
+    local_rows.num_vertices = partition.size(rank);
+    std::vector<int> degrees(local_rows.num_vertices);
+    std::vector<int> counts = partition.counts(), displs = partition.displs();
+    MPI_Scatterv(all_degrees.data(), counts.data(), displs.data(), MPI_INT, degrees.data(), local_rows.num_vertices, MPI_INT, 0, comm);
+
+    local_rows.row_offsets.assign(local_rows.num_vertices + 1, 0);
+    std::partial_sum(degrees.begin(), degrees.end(), local_rows.row_offsets.begin() + 1);
+    int local_edges = local_rows.row_offsets.back();
+    local_rows.col_indices.resize(local_edges);
+    local_rows.weights.resize(local_edges);
+    MPI_Scatterv(graph.col_indices.data(), edge_counts.data(), edge_displs.data(), MPI_INT, local_rows.col_indices.data(), local_edges, MPI_INT, 0, comm);
+    MPI_Scatterv(graph.weights.data(), edge_counts.data(), edge_displs.data(), MPI_INT, local_rows.weights.data(), local_edges, MPI_INT, 0, comm);
+    return local_rows;
+}
+
+/**
+ * @brief Перенумерация распределённого CSR-графа (коллективная операция).
+ *
+ * Блоки строк собираются на процессе 0, он строит перестановку и переставляет граф,
+ * новые блоки раздаются по тому же разбиению. При нумерации, сближающей концы рёбер
+ * (rcm, bfs), соседи вершины чаще попадают в блок того же процесса: меньше дуг разреза
+ * и запросов релаксации в обмене. Процессу 0 нужна память O(n + m) под весь граф.
+ *
+ * @param local_rows [in/out] Блок строк процесса; на выходе — блок в новой нумерации.
+ * @param quality_before, quality_after [out] Показатели нумерации (заполняются на процессе 0).
+ * @return Перестановка (одинаковая на всех процессах).
+ */
+inline VertexPermutation reorderCsrBlocksMpi(CsrGraph &local_rows, const BlockPartition &partition, VertexOrder kind,
+                                             OrderingQuality &quality_before, OrderingQuality &quality_after, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    VertexPermutation perm;
+    CsrGraph graph = gatherCsrBlocks(local_rows, partition, comm);
+    if (rank == 0) {
+        quality_before = orderingQuality(graph);
+        perm = computeVertexOrder(graph, kind);
+        graph = permuteCsr(graph, perm);
+        quality_after = orderingQuality(graph);
+    } else {
+        perm.order.resize(partition.total);
+    }
+    local_rows = scatterCsrBlocks(graph, partition, comm);
+
+    MPI_Bcast(perm.order.data(), partition.total, MPI_INT, 0, comm);
+    perm.new_id.resize(partition.total);
+    for (int k = 0; k < partition.total; ++k) perm.new_id[perm.order[k]] = k;
+    return perm;
+}
+
+/**
+ * @brief Перевод результатов своего блока из новой нумерации в исходную (коллективная операция).
+ *
+ * До вызова процесс хранит вершины [begin, end) новой нумерации, после — вершины того же
+ * отрезка исходной: тройки {исходный номер, расстояние, предок} уходят владельцам одним
+ * MPI_Alltoallv. Каждый процесс затем пишет свой отрезок файла результата, без сбора на процессе 0.
+ * @param dist, pred Результаты своего блока в новой нумерации (предки — новые номера).
+ * @param out_dist, out_pred [out] Результаты вершин своего отрезка в исходной нумерации.
+ */
+inline void restoreOriginalIdsMpi(const VertexPermutation &perm, const BlockPartition &partition, const int *dist, const int *pred,
+                                  int *out_dist, int *out_pred, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    const int first = partition.begin(rank);
+    std::vector<std::vector<int>> outgoing(partition.parts);
+    for (int i = 0; i < partition.size(rank); ++i) {
+        const int v = perm.order[first + i];
+        std::vector<int> &to = outgoing[partition.owner(v)];
+        to.push_back(v);
+        to.push_back(dist[i]);
+        to.push_back(pred[i] == -1 ? -1 : perm.order[pred[i]]);
+    }
+
+    std::vector<int> incoming;
+    delta_stepping_mpi_detail::exchangeRequests(outgoing, incoming, comm);
+    for (std::size_t k = 0; k < incoming.size(); k += 3) {
+        out_dist[incoming[k] - first] = incoming[k + 1];
+        out_pred[incoming[k] - first] = incoming[k + 2];
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <mpi.h>
+#include "../common/result_file.hpp"
+#include "dist_type_mpi.hpp"
+
+/**
+ * @brief Коллективная запись файла результата (см. result_file.hpp) без сбора на процессе 0.
+ *
+ * Процесс 0 пишет заголовок, каждый процесс — свой отрезок [first_vertex, first_vertex + count)
+ * массивов dist и pred по смещениям, которые следуют из заголовка (MPI_File_write_at_all).
+ * Процессы, чьи вершины уже записаны другими (строки решётки 2D кроме первой), передают count = 0.
+ *
+ * @tparam D Тип расстояния (int или std::int64_t), недостижимая вершина — distInfinity<D>().
+ * @param dist, pred Отрезки массивов процесса.
+ * @return Одинаковый на всех процессах признак успеха.
+ */
+template <typename D>
+inline bool writeResultFileMpi(const std::string &path, int countVertices, int source, int target,
+                               int first_vertex, int count, const D *dist, const int *pred, MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    MPI_File fh;
+    if (MPI_File_open(comm, path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) return false;
+
+    const ResultFileHeader header = makeResultHeader(countVertices, source, target, sizeof(D));
+    int ok = MPI_File_set_size(fh, static_cast<MPI_Offset>(resultFileSize(header))) == MPI_SUCCESS;
+
+    // Заголовок пишет процесс 0, остальные участвуют в коллективной операции с нулевым объёмом
+    ok &= MPI_File_write_at_all(fh, 0, &header, rank == 0 ? sizeof(header) : 0, MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    ok &= MPI_File_write_at_all(fh, static_cast<MPI_Offset>(header.dist_offset + sizeof(D) * static_cast<std::uint64_t>(first_vertex)),
+                                dist, count, mpiDistType<D>(), MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    ok &= MPI_File_write_at_all(fh, static_cast<MPI_Offset>(header.pred_offset + sizeof(int) * static_cast<std::uint64_t>(first_vertex)),
+                                pred, count, MPI_INT, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    ok &= MPI_File_close(&fh) == MPI_SUCCESS;
+
+    int all_ok = 0;
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    return all_ok != 0;
+}
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/graph_file.hpp"
+#include "../common/graph_generator.hpp"
+#include "../common/priority_queue.hpp"
+#include "../common/profile.hpp"
+#include "delta_stepping.hpp"
+
+/**
+ * Индекс ориентиров для запросов "точка — точка" (ALT: A*, landmarks, triangle inequality).
+ *
+ * Для K выбранных вершин-ориентиров L хранятся расстояния d(L, v) (и d(v, L) для ориентированного
+ * графа). По неравенству треугольника d(v, t) >= d(L, t) - d(L, v) и d(v, t) >= d(v, L) - d(t, L),
+ * так что максимум этих разностей — допустимая и согласованная оценка остатка пути, и A* с ней
+ * обрабатывает вершины примерно вдоль кратчайшего пути, а не шар радиуса d(s, t).
+ *
+ * Файл индекса (порядок байт машины):
+ *   LandmarkFileHeader (64 байта)
+ *   landmarks[K] (int32), выровнено на 8
+ *   from[n * K] (int32): from[v * K + i] = d(L_i, v), INF — недостижима
+ *   to[n * K]   (int32): to[v * K + i] = d(v, L_i) — только для ориентированного графа
+ * Расстояния вершины лежат подряд: оценка вершины читает одну-две кэш-строки.
+ */
+constexpr char kLandmarkFileMagic[8] = {'S', 'S', 'S', 'P', 'A', 'L', 'T', '1'};
+constexpr std::uint32_t kLandmarkFileVersion = 1;
+
+struct LandmarkFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_landmarks;
+    std::uint32_t flags;         // GraphFlags: kFlagSymmetric — таблица to не хранится
+    std::uint32_t reserved0;
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;
+    std::uint64_t graph_hash;    // отпечаток графа (csrFingerprint)
+    std::uint8_t reserved[16];
+};
+static_assert(sizeof(LandmarkFileHeader) == 64, "LandmarkFileHeader must be 64 bytes");
+
+/**
+ * @brief Таблицы расстояний до ориентиров.
+ */
+struct LandmarkIndex {
+    int num_vertices = 0;
+    int num_landmarks = 0;
+    bool symmetric = true;
+    std::uint64_t graph_hash = 0;
+    std::vector<int> landmarks;
+    std::vector<int> from; // from[v * K + i] = d(L_i, v)
+    std::vector<int> to;   // to[v * K + i] = d(v, L_i); пусто для неориентированного графа
+
+    const int *fromRow(int v) const { return from.data() + static_cast<std::size_t>(v) * num_landmarks; }
+    const int *toRow(int v) const { return (symmetric ? from.data() : to.data()) + static_cast<std::size_t>(v) * num_landmarks; }
+    std::size_t bytes() const { return (landmarks.size() + from.size() + to.size()) * sizeof(int); }
+};
+
+/**
+ * @brief Отпечаток CSR-графа: индекс, построенный для другого графа, не загружается.
+ */
+inline std::uint64_t csrFingerprint(const CsrGraph &graph) {
+    std::uint64_t h = splitMix64(static_cast<std::uint64_t>(graph.num_vertices));
+    for (int u = 0; u < graph.num_vertices; ++u) {
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            std::uint64_t arc = (static_cast<std::uint64_t>(graph.col_indices[e]) << 32) | static_cast<std::uint32_t>(graph.weights[e]);
+            h = splitMix64(h ^ arc);
+        }
+        h = splitMix64(h ^ static_cast<std::uint64_t>(u));
+    }
+    return h;
+}
+
+/**
+ * @brief Построение индекса: K ориентиров выбираются «самыми дальними».
+ *
+ * Первый ориентир — самая дальняя достижимая вершина от first, каждый следующий — вершина,
+ * наиболее удалённая от уже выбранных (максимум минимального расстояния). Ориентиры на краях
+ * графа дают оценки, близкие к точным, для большинства направлений запроса.
+ * Деревья ориентиров строит многопоточный delta-stepping: по graph — d(L, v), по backward — d(v, L).
+ *
+ * @param backward Транспонированный граф (для неориентированного не используется).
+ * @param first Вершина, от которой ищется первый ориентир.
+ * @param num_threads Потоки delta-stepping.
+ */
+inline LandmarkIndex buildLandmarkIndex(const CsrGraph &graph, const CsrGraph &backward, bool symmetric, int num_landmarks, int first, int num_threads) {
+    const int n = graph.num_vertices;
+    const int K = std::max(1, std::min(num_landmarks, n));
+    LandmarkIndex index;
+    index.num_vertices = n;
+    index.num_landmarks = K;
+    index.symmetric = symmetric;
+    index.graph_hash = csrFingerprint(graph);
+    index.from.assign(static_cast<std::size_t>(n) * K, INF);
+    if (!symmetric) index.to.assign(static_cast<std::size_t>(n) * K, INF);
+
+    std::vector<int> dist(n), pred(n);
+    std::vector<int> nearest(n, INF); // расстояние от ближайшего выбранного ориентира
+    const int delta = autoDelta(graph);
+
+    // Самая дальняя вершина с конечной оценкой; -1, если все вершины уже ориентиры или недостижимы
+    auto farthest = [&](const std::vector<int> &score) {
+        int best = -1;
+        for (int v = 0; v < n; ++v) {
+            if (score[v] != INF && score[v] > 0 && (best == -1 || score[v] > score[best])) best = v;
+        }
+        return best;
+    };
+
+    dijkstra_delta_stepping(graph, first, -1, dist.data(), pred.data(), num_threads, delta);
+    int landmark = farthest(dist);
+    if (landmark == -1) landmark = first;
+
+    for (int i = 0; i < K && landmark != -1; ++i) {
+        index.landmarks.push_back(landmark);
+        dijkstra_delta_stepping(graph, landmark, -1, dist.data(), pred.data(), num_threads, delta);
+        for (int v = 0; v < n; ++v) {
+            index.from[static_cast<std::size_t>(v) * K + i] = dist[v];
+            nearest[v] = std::min(nearest[v], dist[v]);
+        }
+        if (!symmetric) {
+            dijkstra_delta_stepping(backward, landmark, -1, dist.data(), pred.data(), num_threads, delta);
+            for (int v = 0; v < n; ++v) index.to[static_cast<std::size_t>(v) * K + i] = dist[v];
+        }
+        landmark = farthest(nearest);
+    }
+
+    // Граф меньше K достижимых «дальних» вершин: таблицы сжимаются до выбранных ориентиров
+    const int chosen = static_cast<int>(index.landmarks.size());
+    if (chosen < K) {
+        auto shrink = [&](std::vector<int> &table) {
+            if (table.empty()) return;
+            for (int v = 0; v < n; ++v) {
+                std::copy_n(table.begin() + static_cast<std::size_t>(v) * K, chosen, table.begin() + static_cast<std::size_t>(v) * chosen);
+            }
+            table.resize(static_cast<std::size_t>(n) * chosen);
+        };
+        shrink(index.from);
+        shrink(index.to);
+        index.num_landmarks = chosen;
+    }
+    return index;
+}
+
+/**
+ * @brief Запись индекса в файл.
+ * @return false при ошибке ввода-вывода.
+ */
+inline bool writeLandmarkIndex(const std::string &path, const LandmarkIndex &index, std::uint64_t num_edges) {
+    LandmarkFileHeader header{};
+    std::memcpy(header.magic, kLandmarkFileMagic, sizeof(header.magic));
+    header.version = kLandmarkFileVersion;
+    header.num_landmarks = static_cast<std::uint32_t>(index.num_landmarks);
+    header.flags = index.symmetric ? kFlagSymmetric : 0;
+    header.num_vertices = static_cast<std::uint64_t>(index.num_vertices);
+    header.num_edges = num_edges;
+    header.graph_hash = index.graph_hash;
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const char padding[8] = {};
+    const std::size_t landmark_bytes = index.landmarks.size() * sizeof(int);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(index.landmarks.data(), 1, landmark_bytes, file) == landmark_bytes &&
+              std::fwrite(padding, 1, alignTo8(landmark_bytes) - landmark_bytes, file) == alignTo8(landmark_bytes) - landmark_bytes &&
+              std::fwrite(index.from.data(), sizeof(int), index.from.size(), file) == index.from.size() &&
+              std::fwrite(index.to.data(), sizeof(int), index.to.size(), file) == index.to.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * @brief Чтение индекса с проверкой, что он построен для graph.
+ * @return false, если файл не читается или не соответствует графу (описание в error).
+ */
+inline bool readLandmarkIndex(const std::string &path, const CsrGraph &graph, LandmarkIndex &index, std::string &error) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    LandmarkFileHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1;
+    if (!ok || std::memcmp(header.magic, kLandmarkFileMagic, sizeof(kLandmarkFileMagic)) != 0 || header.version != kLandmarkFileVersion ||
+        header.num_landmarks == 0 || header.num_vertices > static_cast<std::uint64_t>(INF)) {
+        std::fclose(file);
+        error = "неверный заголовок индекса ориентиров";
+        return false;
+    }
+    if (header.num_vertices != static_cast<std::uint64_t>(graph.num_vertices) || header.num_edges != static_cast<std::uint64_t>(graph.numEdges()) ||
+        header.graph_hash != csrFingerprint(graph)) {
+        std::fclose(file);
+        error = "индекс построен для другого графа";
+        return false;
+    }
+
+    index.num_vertices = graph.num_vertices;
+    index.num_landmarks = static_cast<int>(header.num_landmarks);
+    index.symmetric = (header.flags & kFlagSymmetric) != 0;
+    index.graph_hash = header.graph_hash;
+    index.landmarks.resize(index.num_landmarks);
+    const std::size_t table = static_cast<std::size_t>(index.num_vertices) * index.num_landmarks;
+    index.from.resize(table);
+    index.to.resize(index.symmetric ? 0 : table);
+
+    const std::size_t landmark_bytes = index.landmarks.size() * sizeof(int);
+    char padding[8];
+    ok = std::fread(index.landmarks.data(), 1, landmark_bytes, file) == landmark_bytes &&
+         std::fread(padding, 1, alignTo8(landmark_bytes) - landmark_bytes, file) == alignTo8(landmark_bytes) - landmark_bytes &&
+         std::fread(index.from.data(), sizeof(int), index.from.size(), file) == index.from.size() &&
+         std::fread(index.to.data(), sizeof(int), index.to.size(), file) == index.to.size();
+    std::fclose(file);
+    if (!ok) error = "файл индекса обрезан";
+    return ok;
+}
+
+/**
+ * @brief A* с оценкой по ориентирам для запросов "точка — точка".
+ *
+ * Рабочие массивы принадлежат объекту и помечаются номером запроса, поэтому запрос не
+ * инициализирует n элементов: его стоимость пропорциональна обработанной части графа,
+ * а не размеру графа. Оценка вершины вычисляется один раз — при первом её достижении.
+ * Для запроса берутся kActive ориентиров с лучшей оценкой d(s, t): остальные обычно
+ * почти не уточняют её, но удорожают каждую вершину.
+ */
+class AltSearch {
+public:
+    static constexpr int kActive = 4;
+
+    AltSearch(const CsrGraph &graph, const LandmarkIndex &index)
+        : graph_(graph), index_(index), dist_(graph.num_vertices), pred_(graph.num_vertices),
+          potential_(graph.num_vertices), stamp_(graph.num_vertices, 0) {}
+
+    /**
+     * @brief Кратчайший путь source -> target.
+     * @param path [out] Вершины пути от source до target (пусто — target недостижима).
+     * @param profile [out] Профиль запуска (nullptr — без профилирования).
+     * @return Длина пути (INF — недостижима).
+     */
+    int query(int source, int target, std::vector<int> &path, RunProfile *profile = nullptr) {
+        if (++epoch_ == 0) {
+            std::fill(stamp_.begin(), stamp_.end(), 0);
+            epoch_ = 1;
+        }
+        chooseLandmarks(source, target);
+        path.clear();
+        settled_ = 0;
+
+        queue_.clear();
+        reach(source, 0, -1);
+        queue_.push({potential_[source], source});
+
+        std::uint64_t attempted = 0, successful = 0;
+        int result = INF;
+        while (!queue_.empty()) {
+            PhaseTimer select_timer(profile, kPhaseSelect);
+            QueueItem item = queue_.pop();
+            int u = item.vertex;
+            if (item.dist > key(u)) continue; // устаревшая копия
+            select_timer.stop();
+
+            ++settled_;
+            if (u == target) {
+                result = dist_[u];
+                break;
+            }
+
+            PhaseTimer relax_timer(profile, kPhaseRelax);
+            attempted += graph_.row_offsets[u + 1] - graph_.row_offsets[u];
+            for (int e = graph_.row_offsets[u]; e < graph_.row_offsets[u + 1]; ++e) {
+                int v = graph_.col_indices[e];
+                int w = graph_.weights[e];
+                if (dist_[u] > INF - w) continue;
+
+                int new_dist = dist_[u] + w;
+                if (stamp_[v] != epoch_) {
+                    reach(v, new_dist, u);
+                } else if (new_dist < dist_[v]) {
+                    dist_[v] = new_dist;
+                    pred_[v] = u;
+                } else {
+                    continue;
+                }
+                if (potential_[v] == INF) continue; // target недостижима из v
+                queue_.push({key(v), v});
+                ++successful;
+            }
+        }
+
+        if (profile) {
+            profile->iterations += settled_;
+            profile->relax_attempted += attempted;
+            profile->relax_successful += successful;
+        }
+        if (result != INF) {
+            for (int v = target; v != -1; v = pred_[v]) path.push_back(v);
+            std::reverse(path.begin(), path.end());
+        }
+        return result;
+    }
+
+    // Вершины, извлечённые последним запросом
+    int settled() const { return settled_; }
+    int activeLandmarks() const { return static_cast<int>(active_.size()); }
+    // Расстояние от source последнего запроса до вершины его пути
+    int distance(int v) const { return dist_[v]; }
+
+private:
+    // Ключ очереди g + h с насыщением: расстояния ограничены INF
+    int key(int v) const { return dist_[v] > INF - potential_[v] ? INF : dist_[v] + potential_[v]; }
+
+    void reach(int v, int d, int parent) {
+        stamp_[v] = epoch_;
+        dist_[v] = d;
+        pred_[v] = parent;
+        potential_[v] = estimate(v);
+    }
+
+    // Нижняя оценка d(v, target) по активным ориентирам; INF — target недостижима из v
+    int estimate(int v) const {
+        const int *from_v = index_.fromRow(v);
+        const int *to_v = index_.toRow(v);
+        int best = 0;
+        for (std::size_t k = 0; k < active_.size(); ++k) {
+            const int i = active_[k];
+            // d(L, t) <= d(L, v) + d(v, t)
+            if (from_v[i] != INF && target_from_[k] != INF && target_from_[k] - from_v[i] > best) best = target_from_[k] - from_v[i];
+            if (from_v[i] != INF && target_from_[k] == INF) return INF;
+            // d(v, L) <= d(v, t) + d(t, L)
+            if (to_v[i] != INF && target_to_[k] != INF && to_v[i] - target_to_[k] > best) best = to_v[i] - target_to_[k];
+        }
+        return best;
+    }
+
+    void chooseLandmarks(int source, int target) {
+        const int K = index_.num_landmarks;
+        const int *from_s = index_.fromRow(source), *to_s = index_.toRow(source);
+        const int *from_t = index_.fromRow(target), *to_t = index_.toRow(target);
+
+        std::vector<std::pair<int, int>> bounds(K); // {-оценка d(s, t) по ориентиру, ориентир}
+        for (int i = 0; i < K; ++i) {
+            int bound = 0;
+            if (from_s[i] != INF && from_t[i] != INF) bound = std::max(bound, from_t[i] - from_s[i]);
+            if (to_s[i] != INF && to_t[i] != INF) bound = std::max(bound, to_s[i] - to_t[i]);
+            bounds[i] = {-bound, i};
+        }
+        std::sort(bounds.begin(), bounds.end());
+
+        active_.clear();
+        target_from_.clear();
+        target_to_.clear();
+        for (int k = 0; k < std::min(kActive, K); ++k) {
+            int i = bounds[k].second;
+            active_.push_back(i);
+            target_from_.push_back(from_t[i]);
+            target_to_.push_back(to_t[i]);
+        }
+    }
+
+    const CsrGraph &graph_;
+    const LandmarkIndex &index_;
+    std::vector<int> dist_, pred_, potential_;
+    std::vector<std::uint32_t> stamp_; // номер запроса, в котором вершина достигнута
+    std::uint32_t epoch_ = 0;
+    std::vector<int> active_, target_from_, target_to_;
+    BinaryHeap queue_;
+    int settled_ = 0;
+};
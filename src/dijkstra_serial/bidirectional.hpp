@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/priority_queue.hpp"
+#include "../common/profile.hpp"
+
+/**
+ * @brief Рабочие массивы двунаправленного поиска, переиспользуемые между запросами.
+ *
+ * Расстояния и преемники обратного поиска и позиции вершин склеиваемого пути помечаются
+ * номером запроса (как в AltSearch): запрос не выделяет и не инициализирует n элементов,
+ * элемент сбрасывается при первом обращении к нему в текущем запросе.
+ */
+class BidirectionalScratch {
+public:
+    /**
+     * @brief Начало запроса на графе из n вершин: все элементы становятся «нетронутыми».
+     */
+    void begin(int n) {
+        if (static_cast<int>(back_dist_.size()) != n) {
+            back_dist_.assign(n, INF);
+            succ_.assign(n, -1);
+            position_.assign(n, -1);
+            back_stamp_.assign(n, 0);
+            position_stamp_.assign(n, 0);
+            epoch_ = 0;
+        }
+        if (++epoch_ == 0) {
+            std::fill(back_stamp_.begin(), back_stamp_.end(), 0);
+            std::fill(position_stamp_.begin(), position_stamp_.end(), 0);
+            epoch_ = 1;
+        }
+    }
+
+    // Расстояние обратного поиска (INF — не достигнута) и следующая вершина на пути к target
+    int &backDist(int v) { return touchBack(v), back_dist_[v]; }
+    int &succ(int v) { return touchBack(v), succ_[v]; }
+    // Позиция вершины в склеиваемом пути (-1 — не на пути)
+    int &position(int v) {
+        if (position_stamp_[v] != epoch_) {
+            position_stamp_[v] = epoch_;
+            position_[v] = -1;
+        }
+        return position_[v];
+    }
+
+private:
+    void touchBack(int v) {
+        if (back_stamp_[v] != epoch_) {
+            back_stamp_[v] = epoch_;
+            back_dist_[v] = INF;
+            succ_[v] = -1;
+        }
+    }
+
+    std::vector<int> back_dist_, succ_, position_;
+    std::vector<std::uint32_t> back_stamp_, position_stamp_;
+    std::uint32_t epoch_ = 0;
+};
+
+/**
+ * @brief Двунаправленный Дейкстра для запроса "точка — точка" на CSR-графе.
+ *
+ * Прямой поиск идёт от source по графу forward, обратный — от target по транспонированному
+ * графу backward; шаг делает сторона с меньшей очередью. mu — длина лучшего найденного
+ * пути через ребро между фронтами. Очереди не дают заглянуть в вершину без извлечения,
+ * поэтому критерий остановки top_f + top_b >= mu проверяется по последним извлечённым
+ * ключам: они монотонны и не больше текущих вершин очередей, так что остановка
+ * корректна и наступает не более чем на шаг позже.
+ *
+ * После поиска dist и pred вдоль найденного пути согласованы с обычным деревом
+ * кратчайших путей: путь восстанавливается проходом по pred от target.
+ * Остальные элементы dist — верхние оценки прямого поиска.
+ *
+ * @tparam Queue Очередь с приоритетом (DaryHeap<k>, DialQueue).
+ * @param forward CSR-граф.
+ * @param backward Транспонированный граф (для неориентированного — тот же forward).
+ * @param source Стартовая вершина.
+ * @param target Целевая вершина.
+ * @param dist [out] Расстояния прямого поиска; dist[target] — длина кратчайшего пути (INF — недостижима).
+ * @param pred [out] Предшественники прямого поиска, достроенные вдоль пути до target.
+ * @param forward_queue Рабочая очередь прямого поиска.
+ * @param backward_queue Рабочая очередь обратного поиска.
+ * @param scratch Рабочие массивы обратного поиска (BidirectionalScratch), общие для запросов.
+ * @param profile [out] Профиль запуска (nullptr — без профилирования).
+ * @return Число извлечённых вершин обоих поисков.
+ */
+template <typename Queue>
+int dijkstra_bidirectional(const CsrGraph &forward, const CsrGraph &backward, int source, int target, int *dist, int *pred,
+                           Queue &forward_queue, Queue &backward_queue, BidirectionalScratch &scratch, RunProfile *profile = nullptr) {
+    const int n = forward.num_vertices;
+    scratch.begin(n);
+    auto forward_dist = [&](int v) -> int & { return dist[v]; };
+    auto forward_pred = [&](int v) -> int & { return pred[v]; };
+    auto back_dist = [&](int v) -> int & { return scratch.backDist(v); };
+    auto succ = [&](int v) -> int & { return scratch.succ(v); }; // предок обратного поиска
+
+    for (int i = 0; i < n; i++) {
+        dist[i] = INF;
+        pred[i] = -1;
+    }
+    dist[source] = 0;
+    back_dist(target) = 0;
+    if (source == target) return 1;
+
+    forward_queue.clear();
+    backward_queue.clear();
+    forward_queue.push({0, source});
+    backward_queue.push({0, target});
+
+    long long mu = INF;         // длина лучшего пути через ребро meet_from -> meet_to
+    int meet_from = -1, meet_to = -1;
+    long long last[2] = {0, 0}; // последние извлечённые ключи прямого и обратного поиска
+    std::uint64_t settled = 0, attempted = 0, successful = 0;
+
+    // Один шаг поиска: извлечь вершину, релаксировать её дуги, обновить mu через чужой фронт
+    auto step = [&](int side, const CsrGraph &graph, Queue &queue, auto &&own_dist, auto &&own_pred, auto &&other_dist) {
+        PhaseTimer select_timer(profile, kPhaseSelect);
+        QueueItem item = queue.pop();
+        int u = item.vertex;
+        const int du = own_dist(u);
+        if (item.dist > du) return; // устаревшая копия
+        select_timer.stop();
+
+        PhaseTimer relax_timer(profile, kPhaseRelax);
+        last[side] = item.dist;
+        ++settled;
+        attempted += graph.row_offsets[u + 1] - graph.row_offsets[u];
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; e++) {
+            int v = graph.col_indices[e];
+            int w = graph.weights[e];
+            if (du > INF - w) continue;
+
+            int new_dist = du + w;
+            int &dv = own_dist(v);
+            if (new_dist < dv) {
+                dv = new_dist;
+                own_pred(v) = u;
+                queue.push({new_dist, v});
+                ++successful;
+            }
+            int other = other_dist(v);
+            if (other != INF && static_cast<long long>(new_dist) + other < mu) {
+                mu = static_cast<long long>(new_dist) + other;
+                meet_from = side == 0 ? u : v;
+                meet_to = side == 0 ? v : u;
+            }
+        }
+    };
+
+    while (!forward_queue.empty() && !backward_queue.empty() && last[0] + last[1] < mu) {
+        if (forward_queue.size() <= backward_queue.size()) {
+            step(0, forward, forward_queue, forward_dist, forward_pred, back_dist);
+        } else {
+            step(1, backward, backward_queue, back_dist, succ, forward_dist);
+        }
+    }
+
+    if (profile) {
+        profile->iterations += settled;
+        profile->relax_attempted += attempted;
+        profile->relax_successful += successful;
+    }
+    if (meet_from == -1) {
+        dist[target] = INF;
+        pred[target] = -1;
+        return static_cast<int>(settled);
+    }
+
+    // Путь: source ... meet_from по pred, затем meet_to ... target по succ.
+    // Рёбра нулевого веса могут дать повтор вершины — такой цикл нулевой длины вырезается.
+    std::vector<int> path;
+    for (int v = meet_from; v != -1; v = pred[v]) path.push_back(v);
+    const std::size_t forward_part = path.size();
+    std::reverse(path.begin(), path.end());
+    for (std::size_t k = 0; k < path.size(); ++k) scratch.position(path[k]) = static_cast<int>(k);
+
+    std::size_t kept_forward = forward_part; // вершины пути с расстояниями прямого поиска
+    for (int v = meet_to; v != -1; v = succ(v)) {
+        int &position = scratch.position(v);
+        if (position != -1) {
+            const std::size_t keep = position + 1;
+            for (std::size_t k = keep; k < path.size(); ++k) scratch.position(path[k]) = -1;
+            path.resize(keep);
+            if (path.size() < kept_forward) kept_forward = path.size();
+            continue;
+        }
+        position = static_cast<int>(path.size());
+        path.push_back(v);
+    }
+
+    for (std::size_t k = 1; k < path.size(); ++k) {
+        pred[path[k]] = path[k - 1];
+        if (k >= kept_forward) dist[path[k]] = static_cast<int>(mu - back_dist(path[k]));
+    }
+    return static_cast<int>(settled);
+}
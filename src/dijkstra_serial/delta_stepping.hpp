@@ -0,0 +1,273 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/profile.hpp"
+#include "../common/thread_team.hpp"
+
+/**
+ * @brief Автоподбор delta по диапазону весов: delta ~ max_weight / средняя степень.
+ *
+ * При таком delta в корзине в среднем оказывается O(1) лёгких рёбер на вершину,
+ * что балансирует число фаз и объём повторных релаксаций.
+ */
+inline int autoDelta(const CsrGraph &graph) {
+    int n = graph.num_vertices;
+    if (n == 0) return 1;
+
+    int avg_degree = graph.numEdges() / n;
+    if (avg_degree < 1) avg_degree = 1;
+
+    int delta = graph.maxWeight() / avg_degree;
+    return delta < 1 ? 1 : delta;
+}
+
+namespace delta_stepping_detail {
+
+// Расстояние (старшие 32 бита) и предок (младшие 32 бита) обновляются одним CAS
+inline std::uint64_t pack(int dist, int pred) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(dist)) << 32) | static_cast<std::uint32_t>(pred);
+}
+inline int unpackDist(std::uint64_t state) { return static_cast<int>(state >> 32); }
+inline int unpackPred(std::uint64_t state) { return static_cast<int>(static_cast<std::uint32_t>(state)); }
+
+// Отложенная релаксация тяжёлого ребра
+struct Request {
+    int vertex;
+    int dist;
+    int pred;
+};
+
+// Данные одного потока: свои корзины, очередь работы для кражи, буферы
+struct alignas(64) Worker {
+    std::vector<std::vector<int>> buckets; // циклический массив корзин
+    std::mutex queue_mutex;
+    std::vector<int> queue;  // работа текущей фазы; владелец берёт с конца, воры — с начала
+    std::size_t queue_head = 0;
+    std::vector<int> settled;           // вершины, обработанные в текущей корзине
+    std::vector<Request> heavy_buffer;  // буфер релаксаций тяжёлых рёбер
+    std::vector<int> chunk;
+    std::uint64_t relax_attempted = 0;  // счётчики для --profile
+    std::uint64_t relax_successful = 0;
+    int settled_count = 0;              // вершины, обработанные во всех корзинах
+};
+
+constexpr std::size_t kChunkSize = 64;
+
+// Забрать порцию вершин из очереди: from_back — владелец, иначе — кража с начала
+inline bool takeChunk(Worker &victim, std::vector<int> &chunk, bool from_back) {
+    std::lock_guard<std::mutex> lock(victim.queue_mutex);
+    std::size_t available = victim.queue.size() - victim.queue_head;
+    if (available == 0) return false;
+
+    std::size_t count = available < kChunkSize ? available : kChunkSize;
+    chunk.clear();
+    if (from_back) {
+        chunk.assign(victim.queue.end() - count, victim.queue.end());
+        victim.queue.resize(victim.queue.size() - count);
+    } else {
+        chunk.assign(victim.queue.begin() + victim.queue_head, victim.queue.begin() + victim.queue_head + count);
+        victim.queue_head += count;
+    }
+    return true;
+}
+
+} // namespace delta_stepping_detail
+
+/**
+ * @brief Многопоточный delta-stepping (Meyer, Sanders) на CSR-графе.
+ *
+ * Вершины раскладываются по корзинам ширины delta. Корзина с минимальным номером
+ * обрабатывается фазами: лёгкие рёбра (w <= delta) релаксируются сразу, пока корзина
+ * не опустеет, тяжёлые — один раз для всех вершин корзины из буферов потоков.
+ * У каждого потока свои корзины; работа фазы раздаётся через очереди потоков,
+ * и освободившийся поток крадёт порции из чужих очередей.
+ *
+ * @param graph CSR-граф с неотрицательными весами.
+ * @param start Стартовая вершина.
+ * @param target Целевая вершина (-1 — все вершины): поиск останавливается после лёгких фаз
+ *               корзины, в которую попало её расстояние, — тяжёлые рёбра этой корзины
+ *               дают расстояния только в следующих корзинах.
+ * @param dist [out] Массив кратчайших расстояний.
+ * @param pred [out] Массив предшественников для восстановления пути.
+ * @param num_threads Число потоков.
+ * @param delta Ширина корзины (>= 1).
+ * @param profile [out] Профиль запуска (nullptr — без профилирования): счётчики релаксаций
+ *                и число корзин, время ожидания потока 0 на барьерах.
+ * @return Число обработанных вершин.
+ */
+inline int dijkstra_delta_stepping(const CsrGraph &graph, int start, int target, int *dist, int *pred, int num_threads, int delta, RunProfile *profile = nullptr) {
+    using namespace delta_stepping_detail;
+
+    const int n = graph.num_vertices;
+    if (num_threads < 1) num_threads = 1;
+    if (delta < 1) delta = 1;
+
+    std::vector<std::atomic<std::uint64_t>> state(n);
+    std::vector<std::atomic<int>> processed_dist(n);
+    std::vector<std::atomic<int>> settled_bucket(n);
+    for (int v = 0; v < n; ++v) {
+        state[v].store(pack(INF, -1), std::memory_order_relaxed);
+        processed_dist[v].store(INF, std::memory_order_relaxed);
+        settled_bucket[v].store(-1, std::memory_order_relaxed);
+    }
+    state[start].store(pack(0, -1), std::memory_order_relaxed);
+
+    // Все живые расстояния лежат в окне [current * delta, current * delta + delta + max_weight)
+    const std::size_t num_buckets = static_cast<std::size_t>(graph.maxWeight() / delta) + 2;
+
+    std::vector<Worker> workers(num_threads);
+    for (Worker &worker : workers) {
+        worker.buckets.resize(num_buckets);
+    }
+    workers[0].buckets[0].push_back(start);
+
+    // Номера минимальных корзин и флаги непустоты; двойная буферизация по чётности раунда
+    std::vector<long long> min_bucket[2] = {std::vector<long long>(num_threads), std::vector<long long>(num_threads)};
+    std::vector<char> has_work[2] = {std::vector<char>(num_threads), std::vector<char>(num_threads)};
+    ThreadBarrier barrier(num_threads);
+
+    auto worker_loop = [&](int tid) {
+        Worker &self = workers[tid];
+        long long current = 0;
+        int round = 0;
+        RunProfile *timing = tid == 0 ? profile : nullptr;
+        auto wait = [&]() {
+            PhaseTimer timer(timing, kPhaseWait);
+            barrier.wait();
+        };
+
+        // Улучшает расстояние до v; при успехе кладёт v в свою корзину
+        auto relax = [&](int v, int candidate, int u) {
+            std::uint64_t cur = state[v].load(std::memory_order_relaxed);
+            ++self.relax_attempted;
+            while (unpackDist(cur) > candidate) {
+                if (state[v].compare_exchange_weak(cur, pack(candidate, u), std::memory_order_relaxed)) {
+                    self.buckets[static_cast<std::size_t>(candidate / delta) % num_buckets].push_back(v);
+                    ++self.relax_successful;
+                    return;
+                }
+            }
+        };
+
+        while (true) {
+            // 1. Глобально минимальная непустая корзина
+            long long my_min = -1;
+            for (std::size_t k = 0; k < num_buckets; ++k) {
+                if (!self.buckets[static_cast<std::size_t>(current + k) % num_buckets].empty()) {
+                    my_min = current + static_cast<long long>(k);
+                    break;
+                }
+            }
+            min_bucket[round & 1][tid] = my_min;
+            wait();
+
+            long long next = -1;
+            for (long long b : min_bucket[round & 1]) {
+                if (b != -1 && (next == -1 || b < next)) next = b;
+            }
+            ++round;
+            if (next == -1) break;
+            current = next;
+            if (timing) ++timing->iterations;
+            std::vector<int> &bucket = self.buckets[static_cast<std::size_t>(current) % num_buckets];
+
+            // 2. Фазы лёгких рёбер, пока корзина current не опустеет у всех потоков
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(self.queue_mutex);
+                    self.queue.swap(bucket);
+                    self.queue_head = 0;
+                }
+                bucket.clear();
+                wait();
+
+                int victim = tid;
+                bool from_back = true;
+                while (true) {
+                    if (!takeChunk(workers[victim], self.chunk, from_back)) {
+                        // Своя очередь пуста — крадём у следующих потоков по кругу
+                        victim = (victim + 1) % num_threads;
+                        from_back = false;
+                        if (victim == tid) break;
+                        continue;
+                    }
+
+                    for (int u : self.chunk) {
+                        int d = unpackDist(state[u].load(std::memory_order_relaxed));
+                        if (d / delta != current) continue;                               // устаревшая запись
+                        if (processed_dist[u].exchange(d, std::memory_order_relaxed) == d) continue; // уже обработана с этим d
+
+                        if (settled_bucket[u].exchange(static_cast<int>(current), std::memory_order_relaxed) != current) {
+                            self.settled.push_back(u);
+                        }
+
+                        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+                            int w = graph.weights[e];
+                            if (w <= delta && d <= INF - w) relax(graph.col_indices[e], d + w, u);
+                        }
+                    }
+                }
+
+                has_work[round & 1][tid] = !bucket.empty();
+                wait();
+
+                bool any = false;
+                for (char flag : has_work[round & 1]) any = any || flag;
+                ++round;
+                if (!any) break;
+            }
+
+            // Все потоки прошли барьер после лёгких фаз и видят одно и то же решение:
+            // тяжёлые релаксации не могут опустить расстояние в корзину current
+            self.settled_count += static_cast<int>(self.settled.size());
+            if (target >= 0 && unpackDist(state[target].load(std::memory_order_relaxed)) / delta <= current) break;
+
+            // 3. Тяжёлые рёбра обработанных вершин: сначала в буфер, затем применяем
+            for (int u : self.settled) {
+                int d = unpackDist(state[u].load(std::memory_order_relaxed));
+                for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+                    int w = graph.weights[e];
+                    if (w > delta && d <= INF - w) self.heavy_buffer.push_back({graph.col_indices[e], d + w, u});
+                }
+            }
+            for (const Request &request : self.heavy_buffer) {
+                relax(request.vertex, request.dist, request.pred);
+            }
+            self.settled.clear();
+            self.heavy_buffer.clear();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker_loop, t);
+    }
+    worker_loop(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    int settled = 0;
+    for (const Worker &worker : workers) {
+        settled += worker.settled_count;
+    }
+    if (profile) {
+        for (const Worker &worker : workers) {
+            profile->relax_attempted += worker.relax_attempted;
+            profile->relax_successful += worker.relax_successful;
+        }
+    }
+
+    for (int v = 0; v < n; ++v) {
+        std::uint64_t s = state[v].load(std::memory_order_relaxed);
+        dist[v] = unpackDist(s);
+        pred[v] = unpackPred(s);
+    }
+    return settled;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../common/graph.hpp"
+#include "../common/priority_queue.hpp"
+#include "../common/profile.hpp"
+
+/**
+ * @brief Алгоритм Дейкстры на разреженном CSR-графе с подключаемой очередью.
+ *
+ * Сложность O((n + m) log n) для куч и O(n + m + D) для очереди Дайала,
+ * где D — максимальное расстояние.
+ *
+ * @tparam Queue Очередь с приоритетом (DaryHeap<k>, DialQueue).
+ * @param graph CSR-граф.
+ * @param start Стартовая вершина.
+ * @param target Целевая вершина: поиск останавливается при её извлечении из очереди (-1 — все вершины).
+ * @param dist [out] Массив кратчайших расстояний.
+ * @param pred [out] Массив предшественников для восстановления пути.
+ * @param queue Пустая очередь, используемая как рабочая память.
+ * @param profile [out] Профиль запуска (nullptr — без профилирования).
+ * @return Число извлечённых (окончательно обработанных) вершин.
+ */
+template <typename Queue>
+int dijkstra_csr(const CsrGraph &graph, int start, int target, int *dist, int *pred, Queue &queue, RunProfile *profile = nullptr) {
+    int n = graph.num_vertices;
+
+    for (int i = 0; i < n; i++) {
+        dist[i] = INF;
+        pred[i] = -1;
+    }
+
+    dist[start] = 0;
+    queue.clear();
+    queue.push({0, start});
+
+    std::uint64_t settled = 0, attempted = 0, successful = 0;
+    while (!queue.empty()) {
+        PhaseTimer select_timer(profile, kPhaseSelect);
+        QueueItem item = queue.pop();
+        int u = item.vertex;
+
+        // Пропускаем устаревшую копию вершины
+        if (item.dist > dist[u]) continue;
+        select_timer.stop();
+
+        ++settled;
+        if (u == target) break;
+
+        PhaseTimer relax_timer(profile, kPhaseRelax);
+        attempted += graph.row_offsets[u + 1] - graph.row_offsets[u];
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; e++) {
+            int v = graph.col_indices[e];
+            int w = graph.weights[e];
+
+            if (dist[u] <= INF - w) {
+                int new_dist = dist[u] + w;
+                if (new_dist < dist[v]) {
+                    dist[v] = new_dist;
+                    pred[v] = u;
+                    queue.push({new_dist, v});
+                    ++successful;
+                }
+            }
+        }
+    }
+
+    if (profile) {
+        profile->iterations += settled;
+        profile->relax_attempted += attempted;
+        profile->relax_successful += successful;
+    }
+    return static_cast<int>(settled);
+}
@@ -1,158 +1,793 @@
 #include <iostream>
-#include <ctime>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <climits>
+#include <algorithm>
 #include <limits>
+#include <memory>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
-constexpr int INF = std::numeric_limits<int>::max();
+#include <thread>
+#include <type_traits>
+#include "../common/active_set.hpp"
+#include "../common/batch_sssp.hpp"
+#include "../common/cli.hpp"
+#include "../common/graph.hpp"
+#include "../common/graph_file.hpp"
+#include "../common/graph_generator.hpp"
+#include "../common/memory_placement.hpp"
+#include "../common/path.hpp"
+#include "../common/profile.hpp"
+#include "../common/query_server.hpp"
+#include "../common/reorder.hpp"
+#include "../common/result_file.hpp"
+#include "../common/row_block.hpp"
+#include "../common/simd_kernels.hpp"
+#include "../common/weight_types.hpp"
+#include "alt.hpp"
+#include "bidirectional.hpp"
+#include "dijkstra_csr.hpp"
+#include "delta_stepping.hpp"
+#include "incremental.hpp"
 
 /**
- * @brief Генерация графа со случайными весами, возвращает плоский вектор n*n (row-major).
- * @param countVertices Количество вершин.
+ * @brief Последовательный алгоритм Дейкстры.
+ *
+ * Поиск минимума и релаксация строки выполняются SIMD-ядрами, выбранными при запуске,
+ * по сжатому списку непосещённых вершин (ActiveSet): итерация k проходит n - k элементов,
+ * а не все n ячеек dist и признаков посещения.
+ * Индексы матрицы вычисляются в size_t, поэтому n*n может превышать 2^31.
+ *
+ * @tparam W Тип веса матрицы (uint8_t, uint16_t или int); узкие веса уменьшают поток памяти.
+ * @tparam D Тип расстояния (int или std::int64_t для длинных путей).
+ * @tparam Rows Раскладка матрицы (row_block.hpp): DenseRowBlock — полная матрица,
+ *              PackedRowBlock — упакованная симметричная, строка собирается в рабочий буфер.
+ * @param graph Все строки матрицы (в памяти процесса или в отображённом файле).
+ * @param n Количество вершин.
+ * @param start Стартовая вершина.
+ * @param target Целевая вершина: поиск останавливается, как только она посещена (-1 — все вершины).
+ * @param dist [out] Массив кратчайших расстояний.
+ * @param pred [out] Массив предшественников для восстановления пути.
+ * @param kernels Ядра поиска минимума и релаксации (selectSimdKernels).
+ * @param profile [out] Профиль запуска (nullptr — без профилирования).
+ * @return Число посещённых вершин.
  */
-std::vector<int> generateGraph(int countVertices) {
-    std::srand(0); 
+template <typename W, typename D, typename Rows>
+int dijkstra_serial(const Rows &graph, int n, int start, int target, D *dist, int *pred, const SimdKernels<W, D> &kernels, RunProfile *profile = nullptr) {
+    for (int i = 0; i < n; i++) {
+        dist[i] = distInfinity<D>();
+        pred[i] = -1;
+    }
 
-    int n = countVertices;
-    std::vector<int> flat(n * n);
+    dist[start] = 0;
+    ActiveSet<D> active;
+    active.assign(dist, n);
+    std::vector<W> stored_row(graph.rowLength()), row_buffer(n); // строка u, собранная из упакованной раскладки
 
-    for (int i = 0; i < n; ++i) {
-        for (int j = i; j < n; ++j) {
-            int value;
-            if (i == j) {
-                value = 0;
-            } else {
-                value = std::rand() % 100;
-            }
+    std::uint64_t successful = 0;
+    bool reached_target = false;
+    int iteration = 0;
+    for (; iteration < n; iteration++) {
+        PhaseTimer select_timer(profile, kPhaseSelect);
+        int pos = kernels.argmin_active(active.dist(), active.size());
+        select_timer.stop();
 
-            // симметрия для неориентированного графа
-            flat[i * n + j] = value;
-            flat[j * n + i] = value; 
+        if (pos == -1) break;
+        int chosen = active.vertex(pos);
+        D chosen_dist = active.dist()[pos];
+        active.settle(pos, dist);
+        // Расстояние до цели окончательно; строку цели релаксировать незачем
+        if (chosen == target) {
+            reached_target = true;
+            break;
         }
+
+        PhaseTimer relax_timer(profile, kPhaseRelax);
+        const W *row = graph.rowWeights(graph.storedRow(chosen, stored_row.data()), chosen, 0, n, row_buffer.data());
+        successful += kernels.relax_active(row, chosen_dist, chosen, active.ids(), active.dist(), pred, active.size());
     }
+    active.flush(dist);
 
-    return flat;
+    if (profile) {
+        // Итерация k проверяет n - k ещё не посещённых ячеек строки
+        std::uint64_t settled = static_cast<std::uint64_t>(iteration);
+        profile->iterations += settled;
+        profile->relax_attempted += settled * n - settled * (settled + 1) / 2;
+        profile->relax_successful += successful;
+    }
+    return reached_target ? iteration + 1 : iteration;
 }
 
-
 /**
- * @brief Последовательный алгоритм Дейкстры.
+ * @brief Пакетный режим: расстояния от списка источников группами по batch_size.
  *
- * @param graph Плоская матрица смежности графа.
- * @param n Количество вершин.
- * @param start Стартовая вершина.
- * @param dist [out] Массив кратчайших расстояний.
- * @param pred [out] Массив предшественников для восстановления пути.
+ * Каждая группа обрабатывается min-plus ядром batchShortestPaths: строка матрицы,
+ * загруженная из памяти, релаксирует сразу batch_size векторов расстояний.
+ * @param output_path Файл для блока расстояний K*n (пустая строка — не сохранять).
  */
-void dijkstra_serial(const std::vector<int> &graph, int n, int start, int *dist, int *pred) {
-    auto weight = [&](int u, int v) { return graph[u * n + v]; };
+template <typename W>
+int runBatchMode(const W *graph, int n, const std::vector<int> &sources, int batch_size, SimdLevel simd_level,
+                 const std::string &output_path, double read_time_sec) {
+    const int num_sources = static_cast<int>(sources.size());
+    std::vector<int> dist(static_cast<std::size_t>(num_sources) * n);
+    std::vector<int> pred(static_cast<std::size_t>(num_sources) * n);
 
-    std::vector<int> visited(n, 0);
+    auto compute_start = std::chrono::steady_clock::now();
+    RowBlockKernel<W> relax_block = selectRowBlockKernel<W>(simd_level);
+    const int delta = batchBucketWidth(graph, n);
+    std::uint64_t row_loads = 0;
+    for (int first = 0; first < num_sources; first += batch_size) {
+        int count = std::min(batch_size, num_sources - first);
+        std::size_t offset = static_cast<std::size_t>(first) * n;
+        row_loads += batchShortestPaths(graph, n, sources.data() + first, count, dist.data() + offset, pred.data() + offset, relax_block, delta);
+    }
+    auto compute_end = std::chrono::steady_clock::now();
+    double compute_time_sec = std::chrono::duration<double>(compute_end - compute_start).count();
 
-    for (int i = 0; i < n; i++) {
-        dist[i] = INF;
-        pred[i] = -1;
+    std::printf("total_nodes: %d \n", n);
+    // Отдельные запуски плотного движка загрузили бы n строк на источник
+    std::printf("Engine: batch min-plus, sources: %d, batch: %d, row loads: %llu (%.3f of single-source runs)\n", num_sources, batch_size,
+                static_cast<unsigned long long>(row_loads), static_cast<double>(row_loads) / (static_cast<double>(num_sources) * n));
+    std::printf("Compute time: %.6f seconds (%.6f per source)\n", compute_time_sec, compute_time_sec / num_sources);
+    std::printf("Matrix load time: %.6f s\n\n", read_time_sec);
+
+    if (!output_path.empty()) {
+        if (!writeDistanceBlock(output_path, sources, n, dist.data())) {
+            std::fprintf(stderr, "Ошибка записи блока расстояний в %s\n", output_path.c_str());
+            return 1;
+        }
+        std::printf("Distance block %dx%d written to %s\n", num_sources, n, output_path.c_str());
     }
 
-    dist[start] = 0;
+    return 0;
+}
 
-    for (int iteration = 0; iteration < n; iteration++) {
-        int chosen = -1;
-        int best_dist = INF;
+int main(int argc, char *argv[]) {
+    int total_nodes = 200;
+    std::string engine = "dense"; // dense | csr | delta | bidir | alt
+    std::string queue_kind = "binary"; // binary | 4ary | dial (для csr и bidir)
+    int start_vertex = 0;
+    int target_vertex = -1;       // запрос "точка — точка": остановка на цели и вывод пути
+    int num_threads = static_cast<int>(std::thread::hardware_concurrency()); // только для delta
+    int delta = 0; // 0 — автоподбор по диапазону весов (только для delta)
+    std::string sources_spec;  // пакетный режим: "all" или "0,5,7"
+    int batch_size = 32;       // число источников, обрабатываемых вместе
+    std::string batch_output;  // файл для блока расстояний K*n
+    SimdLevel simd_level = detectSimdLevel(); // ядра плотного движка
+    std::string graph_path;       // бинарный файл графа вместо генерации
+    std::string save_graph_path;  // сохранить используемый граф в бинарный файл
+    std::uint32_t weight_bytes = 0; // ширина веса плотной матрицы: 0 — по графу (файл или --max-weight)
+    int dist_bits = 32;             // разрядность расстояний плотного движка
+    std::string storage = "full";   // раскладка матрицы плотного движка: full | packed
+    GeneratorParams generator;    // параметры генерации, если граф не загружается из файла
+    bool profiling = false;       // профиль фаз и счётчики релаксаций
+    bool serve = false;           // режим сервера: граф в памяти, запросы из stdin или сокета
+    std::string socket_path;      // Unix-сокет сервера (пусто — stdin)
+    int cache_size = 16;          // деревьев кратчайших путей в LRU-кэше сервера
+    std::string updates_path;     // пакет изменений весов "u v w" для восстановления дерева
+    int random_updates = 0;       // либо столько случайных изменений существующих дуг
+    VertexOrder reorder = VertexOrder::None; // перенумерация вершин CSR-графа для локальности
+    std::string landmarks_path;   // файл индекса ориентиров движка alt
+    bool build_landmarks = false; // построить индекс и сохранить в landmarks_path
+    int num_landmarks = 16;
+    std::string output_path;      // бинарный файл результата dist/pred (common/result_file.hpp)
+    MemoryPlacement placement;    // страницы и узлы NUMA для матрицы и dist/pred (common/memory_placement.hpp)
 
-        for (int v = 0; v < n; v++) {
-            if (!visited[v] && dist[v] < best_dist) {
-                best_dist = dist[v];
-                chosen = v;
+    // Разбор параметров: [total_nodes] [--engine=dense|csr|delta|bidir|alt] [--queue=binary|4ary|dial]
+    //                    [--source=S] [--target=T]
+    //                    [--threads=N] [--delta=D] [--sources=all|s1,a-b,...] [--batch=K] [--batch-output=file]
+    //                    [--simd=auto|scalar|sse4|avx2|avx512] [--selftest]
+    //                    [--graph=file] [--save-graph=file]
+    //                    [--seed=S] [--density=P] [--min-weight=A] [--max-weight=B]
+    //                    [--weight-bytes=auto|1|2|4] [--dist-bits=32|64] [--storage=full|packed] [--profile]
+    //                    [--serve] [--socket=path] [--cache=K]
+    //                    [--updates=file] [--random-updates=K] [--reorder=none|rcm|degree|bfs]
+    //                    [--landmarks=file] [--build-landmarks] [--num-landmarks=K] [--output=file]
+    //                    [--pages=small|thp|huge] [--numa=default|interleave|partition]
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseGeneratorOption(argv[i], generator)) {
+            continue;
+        } else if (parseOption(argv[i], "--engine", value)) {
+            engine = value;
+        } else if (parseOption(argv[i], "--queue", value)) {
+            queue_kind = value;
+        } else if (parseOption(argv[i], "--source", value)) {
+            start_vertex = std::stoi(value);
+        } else if (parseOption(argv[i], "--target", value)) {
+            target_vertex = std::stoi(value);
+        } else if (parseOption(argv[i], "--threads", value)) {
+            num_threads = std::stoi(value);
+        } else if (parseOption(argv[i], "--delta", value)) {
+            delta = std::stoi(value);
+        } else if (parseOption(argv[i], "--sources", value)) {
+            sources_spec = value;
+        } else if (parseOption(argv[i], "--batch", value)) {
+            batch_size = std::stoi(value);
+        } else if (parseOption(argv[i], "--batch-output", value)) {
+            batch_output = value;
+        } else if (parseOption(argv[i], "--simd", value)) {
+            if (!parseSimdLevel(value, simd_level)) {
+                std::cerr << "Неизвестный уровень SIMD: " << value << " (ожидается auto, scalar, sse4, avx2 или avx512)\n";
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--graph", value)) {
+            graph_path = value;
+        } else if (parseOption(argv[i], "--save-graph", value)) {
+            save_graph_path = value;
+        } else if (parseOption(argv[i], "--weight-bytes", value)) {
+            weight_bytes = value == "auto" ? 0 : static_cast<std::uint32_t>(std::stoul(value));
+        } else if (parseOption(argv[i], "--dist-bits", value)) {
+            dist_bits = std::stoi(value);
+        } else if (parseOption(argv[i], "--storage", value)) {
+            storage = value;
+        } else if (parseFlag(argv[i], "--profile")) {
+            profiling = true;
+        } else if (parseFlag(argv[i], "--serve")) {
+            serve = true;
+        } else if (parseOption(argv[i], "--socket", value)) {
+            socket_path = value;
+            serve = true;
+        } else if (parseOption(argv[i], "--cache", value)) {
+            cache_size = std::stoi(value);
+        } else if (parseOption(argv[i], "--updates", value)) {
+            updates_path = value;
+        } else if (parseOption(argv[i], "--random-updates", value)) {
+            random_updates = std::stoi(value);
+        } else if (parseOption(argv[i], "--reorder", value)) {
+            if (!parseVertexOrder(value, reorder)) {
+                std::cerr << "Неизвестный порядок вершин: " << value << " (ожидается none, rcm, degree или bfs)\n";
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--pages", value)) {
+            if (!parsePageMode(value, placement.pages)) {
+                std::cerr << "Неизвестный размер страниц: " << value << " (ожидается small, thp или huge)\n";
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--numa", value)) {
+            if (!parseNumaMode(value, placement.numa)) {
+                std::cerr << "Неизвестное размещение NUMA: " << value << " (ожидается default, interleave или partition)\n";
+                return 1;
+            }
+        } else if (parseOption(argv[i], "--output", value)) {
+            output_path = value;
+        } else if (parseOption(argv[i], "--landmarks", value)) {
+            landmarks_path = value;
+        } else if (parseFlag(argv[i], "--build-landmarks")) {
+            build_landmarks = true;
+        } else if (parseOption(argv[i], "--num-landmarks", value)) {
+            num_landmarks = std::stoi(value);
+        } else if (parseFlag(argv[i], "--selftest")) {
+            bool simd_ok = simdSelfTest();
+            bool incremental_ok = incrementalSelfTest();
+            bool densify_ok = densifySelfTest();
+            return simd_ok && incremental_ok && densify_ok ? 0 : 1;
+        } else {
+            try {
+                total_nodes = std::stoi(argv[i]);
+            } catch (const std::exception &e) {
+                std::cerr << "Некорректный параметр total_nodes: " << argv[i] << "\n";
+                return 1;
             }
         }
+    }
+
+    if (engine != "dense" && engine != "csr" && engine != "delta" && engine != "bidir" && engine != "alt") {
+        std::cerr << "Неизвестный движок: " << engine << " (ожидается dense, csr, delta, bidir или alt)\n";
+        return 1;
+    }
+    // Движки "точка — точка" не строят дерево путей
+    const bool pair_engine = engine == "bidir" || engine == "alt";
+    if (pair_engine && serve && cache_size > 0) {
+        std::cerr << "Движок " << engine << " не строит дерево путей: в режиме сервера нужен --cache=0\n";
+        return 1;
+    }
+    if (pair_engine && !serve && target_vertex < 0 && !build_landmarks) {
+        std::cerr << "Движку " << engine << " нужна целевая вершина --target\n";
+        return 1;
+    }
+    if ((engine == "alt") != !landmarks_path.empty() || (build_landmarks && engine != "alt") || num_landmarks < 1) {
+        std::cerr << "Движку alt нужен файл индекса --landmarks (--build-landmarks строит его, --num-landmarks >= 1)\n";
+        return 1;
+    }
+    if (target_vertex >= 0 && !sources_spec.empty()) {
+        std::cerr << "--target несовместим с пакетным режимом --sources\n";
+        return 1;
+    }
+    if (serve && (!sources_spec.empty() || profiling || cache_size < 0)) {
+        std::cerr << "--serve несовместим с --sources и --profile, --cache должен быть >= 0\n";
+        return 1;
+    }
+    const bool incremental = !updates_path.empty() || random_updates > 0;
+    if (incremental && (pair_engine || target_vertex >= 0 || serve || !sources_spec.empty() || dist_bits != 32)) {
+        std::cerr << "--updates и --random-updates восстанавливают полное дерево: несовместимы с bidir, alt, --target, --serve, --sources и --dist-bits=64\n";
+        return 1;
+    }
+    if (!output_path.empty() && (engine == "alt" || serve || !sources_spec.empty())) {
+        std::cerr << "--output записывает дерево путей одного расчёта: несовместим с alt, --serve и --sources (для них — --batch-output)\n";
+        return 1;
+    }
+    if (num_threads < 1) num_threads = 1;
+    placement.parts = num_threads; // полосы матрицы и dist/pred — по числу потоков
+    if (queue_kind != "binary" && queue_kind != "4ary" && queue_kind != "dial") {
+        std::cerr << "Неизвестная очередь: " << queue_kind << " (ожидается binary, 4ary или dial)\n";
+        return 1;
+    }
+    std::string generator_error;
+    if (!validateGeneratorParams(generator, generator_error)) {
+        std::cerr << "Некорректные параметры генератора: " << generator_error << "\n";
+        return 1;
+    }
+    if (weight_bytes != 0 && weight_bytes != 1 && weight_bytes != 2 && weight_bytes != 4) {
+        std::cerr << "Некорректная ширина веса: " << weight_bytes << " (ожидается auto, 1, 2 или 4)\n";
+        return 1;
+    }
+    if (dist_bits != 32 && dist_bits != 64) {
+        std::cerr << "Некорректная разрядность расстояний: " << dist_bits << " (ожидается 32 или 64)\n";
+        return 1;
+    }
+    if (storage != "full" && storage != "packed") {
+        std::cerr << "Неизвестная раскладка матрицы: " << storage << " (ожидается full или packed)\n";
+        return 1;
+    }
+    const bool packed = storage == "packed";
+    if (packed && (engine != "dense" || !sources_spec.empty() || !save_graph_path.empty() || incremental)) {
+        std::cerr << "--storage=packed поддерживается только движком dense (без --sources, --save-graph, --updates и --random-updates)\n";
+        return 1;
+    }
+    // Плотный движок просматривает все n ячеек строки при любой нумерации: перенумерация ему не нужна
+    if (reorder != VertexOrder::None && (engine == "dense" || engine == "alt" || !sources_spec.empty() || incremental)) {
+        std::cerr << "--reorder поддерживается движками csr, delta и bidir (без --sources, --updates и --random-updates)\n";
+        return 1;
+    }
 
-        if (chosen == -1) break;
-        visited[chosen] = 1;
+    // Настенное время (steady_clock): clock() суммирует процессорное время всех потоков
+    using steady_clock = std::chrono::steady_clock;
+    steady_clock::time_point read_start = steady_clock::now();
 
-        for (int v = 0; v < n; v++) {
-            int w = weight(chosen, v);
-            if (!visited[v] && w != INF) {
-                if (dist[chosen] <= INF - w) {
-                    int new_dist = dist[chosen] + w;
-                    if (new_dist < dist[v]) {
-                        dist[v] = new_dist;
-                        pred[v] = chosen;
-                    }
+    // Плотная матрица нужна движку dense и пакетному режиму, CSR — движкам csr и delta
+    const bool need_dense = engine == "dense" || !sources_spec.empty();
+    MappedGraphFile graph_file;
+    PlacedArray<std::uint8_t> dense_storage; // собственная плотная матрица (веса ширины weight_bytes)
+    const void *graph_data = nullptr;        // плотная матрица: в dense_storage или прямо в отображённом файле
+                                             // (при --storage=packed — упакованные строки в dense_storage)
+    CsrGraph csr_graph;
+    bool symmetric = true;                   // генератор строит неориентированный граф
+
+    if (!graph_path.empty()) {
+        std::string error;
+        if (!graph_file.open(graph_path, error)) {
+            std::cerr << "Ошибка загрузки графа " << graph_path << ": " << error << "\n";
+            return 1;
+        }
+        total_nodes = graph_file.numVertices();
+        symmetric = graph_file.isSymmetric();
+        weight_bytes = graph_file.header().weight_bytes; // тип веса задаёт файл
+
+        if (packed) {
+            if (!symmetric) {
+                std::cerr << "--storage=packed требует неориентированного графа, " << graph_path << " ориентирован\n";
+                return 1;
+            }
+            dispatchWeightType(weight_bytes, [&](auto tag) {
+                using W = decltype(tag);
+                dense_storage.allocate(PackedRowBlock<W>::blockSize(total_nodes, 0, total_nodes) * sizeof(W), placement);
+                W *rows = reinterpret_cast<W *>(dense_storage.data());
+                const int num_tile_rows = PackedRowBlock<W>::tileCount(total_nodes);
+                if (const W *flat = graph_file.dense<W>()) {
+                    packDenseRows(flat, total_nodes, 0, num_tile_rows, rows);
+                } else {
+                    packCsrRows(graph_file.toCsr(), total_nodes, 0, num_tile_rows, rows);
                 }
+            });
+            graph_data = dense_storage.data();
+        } else if (need_dense || !save_graph_path.empty()) {
+            dispatchWeightType(weight_bytes, [&](auto tag) {
+                using W = decltype(tag);
+                graph_data = graph_file.dense<W>(); // плотный файл используется без копирования
+                if (!graph_data) {
+                    dense_storage.allocate(static_cast<std::size_t>(total_nodes) * total_nodes * sizeof(W), placement);
+                    graph_file.copyDense(reinterpret_cast<W *>(dense_storage.data()));
+                    graph_data = dense_storage.data();
+                }
+            });
+        }
+        if (!need_dense) {
+            csr_graph = graph_file.toCsr();
+        }
+    } else if (need_dense || !save_graph_path.empty()) {
+        // Самый узкий тип веса, вмещающий диапазон генератора (если не задан явно)
+        if (weight_bytes == 0) {
+            weight_bytes = weightBytesFor(generator.max_weight);
+        } else if (generator.max_weight > dispatchWeightType(weight_bytes, [](auto tag) { return WeightTraits<decltype(tag)>::kMaxWeight; })) {
+            std::cerr << "--max-weight=" << generator.max_weight << " не помещается в --weight-bytes=" << weight_bytes << "\n";
+            return 1;
+        }
+        dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            if (packed) {
+                dense_storage.allocate(PackedRowBlock<W>::blockSize(total_nodes, 0, total_nodes) * sizeof(W), placement);
+                packGeneratedRows(generator, total_nodes, 0, total_nodes, reinterpret_cast<W *>(dense_storage.data()));
+            } else {
+                dense_storage.allocate(static_cast<std::size_t>(total_nodes) * total_nodes * sizeof(W), placement);
+                generateDenseRows(generator, total_nodes, 0, total_nodes, reinterpret_cast<W *>(dense_storage.data()));
             }
+        });
+        graph_data = dense_storage.data();
+    } else {
+        // Разреженным движкам плотная матрица не нужна: рёбра генерируются сразу в CSR
+        csr_graph = generateCsrRows(generator, total_nodes, 0, total_nodes);
+    }
+
+    if (!save_graph_path.empty()) {
+        bool saved = dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            return writeDenseGraphFile(save_graph_path, static_cast<const W *>(graph_data), total_nodes, weight_bytes, symmetric);
+        });
+        if (!saved) {
+            std::cerr << "Ошибка записи графа в " << save_graph_path << "\n";
+            return 1;
         }
     }
-}
 
-int main(int argc, char *argv[]) {
-    int total_nodes = 200;
+    if (start_vertex < 0 || start_vertex >= total_nodes || target_vertex >= total_nodes) {
+        std::cerr << "Вершины --source/--target должны лежать в [0, " << total_nodes << ")\n";
+        return 1;
+    }
 
-    // Проверяем, передан ли параметр
-    if (argc > 1) {
-        try {
-            total_nodes = std::stoi(argv[1]);
-        } catch (const std::exception &e) {
-            std::cerr << "Некорректный параметр total_nodes: " << argv[1] << "\n";
+    if (!sources_spec.empty()) {
+        std::vector<int> sources;
+        std::string sources_error;
+        if (!parseSourceList(sources_spec, total_nodes, sources, sources_error)) {
+            std::cerr << "Некорректный список источников " << sources_spec << ": " << sources_error << "\n";
             return 1;
         }
+        double read_time_sec = std::chrono::duration<double>(steady_clock::now() - read_start).count();
+        return dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            return runBatchMode(static_cast<const W *>(graph_data), total_nodes, sources, std::max(1, batch_size), simd_level, batch_output, read_time_sec);
+        });
     }
 
-    clock_t read_start = clock();
-    std::vector<int> graph_matrix = generateGraph(total_nodes);
-
-    int *dist = (int*)std::malloc(total_nodes * sizeof(int));
-    int *pred = (int*)std::malloc(total_nodes * sizeof(int));
+    // Для CSR-движков и восстановления дерева построение разреженного представления входит во время загрузки
+    if ((engine != "dense" || incremental) && csr_graph.num_vertices == 0) {
+        csr_graph = dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            return buildCsrFromDenseRows(static_cast<const W *>(graph_data), total_nodes, total_nodes, 0);
+        });
+    }
+    if (engine == "delta" && delta <= 0) {
+        delta = autoDelta(csr_graph);
+    }
 
-    if (!dist || !pred) {
+    PlacedArray<int> dist_storage, pred_storage;
+    PlacedArray<std::int64_t> dist64;   // расстояния плотного движка при --dist-bits=64
+    try {
+        dist_storage.allocate(total_nodes, placement);
+        pred_storage.allocate(total_nodes, placement);
+        if (engine == "dense" && dist_bits == 64) dist64.allocate(total_nodes, placement);
+    } catch (const std::bad_alloc &) {
         std::fprintf(stderr, "Ошибка выделения памяти dist/pred\n");
         return 1;
     }
+    int *dist = dist_storage.data();
+    int *pred = pred_storage.data();
+    SimdLevel dense_level = SimdLevel::Scalar;
 
-    int start_vertex = 0;
-    clock_t compute_start = clock();
-    dijkstra_serial(graph_matrix, total_nodes, start_vertex, dist, pred);
-    clock_t compute_end = clock();
+    // Обратный поиск bidir идёт по транспонированному графу; неориентированному он не нужен
+    CsrGraph reversed_graph;
+    if ((engine == "bidir" || incremental || build_landmarks) && !symmetric) reversed_graph = transposeCsr(csr_graph);
+    const CsrGraph &backward_graph = symmetric ? csr_graph : reversed_graph;
+
+    // Индекс ориентиров строится (деревья ориентиров — delta-stepping) или читается из файла;
+    // время входит во время загрузки: это предобработка, общая для всех последующих запросов
+    LandmarkIndex landmark_index;
+    std::unique_ptr<AltSearch> alt_search;
+    std::vector<int> alt_path; // путь последнего запроса движка alt
+    double landmarks_time_sec = 0.0;
+    if (engine == "alt") {
+        steady_clock::time_point landmarks_start = steady_clock::now();
+        if (build_landmarks) {
+            landmark_index = buildLandmarkIndex(csr_graph, backward_graph, symmetric, num_landmarks, start_vertex, num_threads);
+            if (!writeLandmarkIndex(landmarks_path, landmark_index, csr_graph.numEdges())) {
+                std::cerr << "Ошибка записи индекса ориентиров в " << landmarks_path << "\n";
+                return 1;
+            }
+        } else {
+            std::string error;
+            if (!readLandmarkIndex(landmarks_path, csr_graph, landmark_index, error)) {
+                std::cerr << "Ошибка загрузки индекса ориентиров: " << error << "\n";
+                return 1;
+            }
+        }
+        landmarks_time_sec = std::chrono::duration<double>(steady_clock::now() - landmarks_start).count();
+        alt_search = std::make_unique<AltSearch>(csr_graph, landmark_index);
+
+        if (!serve && target_vertex < 0) {
+            // Только предобработка: индекс сохранён для последующих запросов
+            std::printf("Landmarks: built %d in %.6f s, index %.1f MB -> %s\n", landmark_index.num_landmarks, landmarks_time_sec,
+                        landmark_index.bytes() / 1e6, landmarks_path.c_str());
+            return 0;
+        }
+    }
+
+    RunProfile run_profile;
+    RunProfile *profile = profiling ? &run_profile : nullptr;
+    VertexPermutation permutation; // при --reorder: нумерация, в которой хранится csr_graph
+    BidirectionalScratch bidir_scratch; // рабочие массивы bidir, общие для запросов (--serve)
+    // Запуск выбранного движка от source (target = -1 — полное дерево); возвращает число обработанных вершин.
+    // Вершины запроса и результаты dist/pred — всегда в исходной нумерации.
+    auto run_engine = [&](int source, int target) {
+        int settled = 0;
+        const bool relabeled = !permutation.order.empty();
+        if (relabeled) {
+            source = permutation.new_id[source];
+            if (target >= 0) target = permutation.new_id[target];
+        }
+        if (engine == "dense") {
+            dispatchWeightType(weight_bytes, [&](auto w_tag) {
+                using W = decltype(w_tag);
+                dispatchDistType(dist_bits, [&](auto d_tag) {
+                    using D = decltype(d_tag);
+                    SimdKernels<W, D> kernels = selectSimdKernels<W, D>(simd_level);
+                    D *dense_dist = nullptr;
+                    if constexpr (std::is_same<D, int>::value) dense_dist = dist;
+                    else dense_dist = dist64.data();
+                    dense_level = kernels.level;
+                    const W *rows = static_cast<const W *>(graph_data);
+                    if (packed) {
+                        settled = dijkstra_serial(PackedRowBlock<W>{rows, total_nodes, 0}, total_nodes, source, target, dense_dist, pred, kernels, profile);
+                    } else {
+                        settled = dijkstra_serial(DenseRowBlock<W>{rows, total_nodes, 0}, total_nodes, source, target, dense_dist, pred, kernels, profile);
+                    }
+                });
+            });
+        } else if (engine == "alt") {
+            // Заполняются только вершины пути: запрос не проходит по всем n элементам dist/pred
+            dist[target] = alt_search->query(source, target, alt_path, profile);
+            pred[target] = -1;
+            for (std::size_t k = 0; k < alt_path.size(); ++k) {
+                dist[alt_path[k]] = alt_search->distance(alt_path[k]);
+                pred[alt_path[k]] = k == 0 ? -1 : alt_path[k - 1];
+            }
+            settled = alt_search->settled();
+        } else if (engine == "delta") {
+            settled = dijkstra_delta_stepping(csr_graph, source, target, dist, pred, num_threads, delta, profile);
+        } else if (engine == "bidir") {
+            if (queue_kind == "binary") {
+                BinaryHeap forward_queue, backward_queue;
+                settled = dijkstra_bidirectional(csr_graph, backward_graph, source, target, dist, pred, forward_queue, backward_queue, bidir_scratch, profile);
+            } else if (queue_kind == "4ary") {
+                QuaternaryHeap forward_queue, backward_queue;
+                settled = dijkstra_bidirectional(csr_graph, backward_graph, source, target, dist, pred, forward_queue, backward_queue, bidir_scratch, profile);
+            } else {
+                DialQueue forward_queue(csr_graph.maxWeight()), backward_queue(csr_graph.maxWeight());
+                settled = dijkstra_bidirectional(csr_graph, backward_graph, source, target, dist, pred, forward_queue, backward_queue, bidir_scratch, profile);
+            }
+        } else if (queue_kind == "binary") {
+            BinaryHeap queue;
+            settled = dijkstra_csr(csr_graph, source, target, dist, pred, queue, profile);
+        } else if (queue_kind == "4ary") {
+            QuaternaryHeap queue;
+            settled = dijkstra_csr(csr_graph, source, target, dist, pred, queue, profile);
+        } else {
+            DialQueue queue(csr_graph.maxWeight());
+            settled = dijkstra_csr(csr_graph, source, target, dist, pred, queue, profile);
+        }
+        if (relabeled) restoreOriginalIds(permutation, dist, pred);
+        return settled;
+    };
+
+    // Перенумерация: сначала эталонный прогон в исходной нумерации (для ускорения и сверки),
+    // затем граф переставляется; время перестановки входит во время загрузки
+    double baseline_time_sec = 0.0, ordering_time_sec = 0.0;
+    std::vector<int> baseline_dist;
+    OrderingQuality quality_before, quality_after;
+    if (reorder != VertexOrder::None) {
+        if (!serve) {
+            RunProfile *saved_profile = profile;
+            profile = nullptr;
+            steady_clock::time_point baseline_start = steady_clock::now();
+            run_engine(start_vertex, target_vertex);
+            baseline_time_sec = std::chrono::duration<double>(steady_clock::now() - baseline_start).count();
+            profile = saved_profile;
+            baseline_dist.assign(dist, dist + total_nodes);
+        }
+        quality_before = orderingQuality(csr_graph);
+        steady_clock::time_point ordering_start = steady_clock::now();
+        permutation = computeVertexOrder(csr_graph, reorder);
+        csr_graph = permuteCsr(csr_graph, permutation);
+        if (engine == "bidir" && !symmetric) reversed_graph = transposeCsr(csr_graph);
+        ordering_time_sec = std::chrono::duration<double>(steady_clock::now() - ordering_start).count();
+        quality_after = orderingQuality(csr_graph);
+    }
+
+    if (serve) {
+        QueryChannel channel;
+        std::string error;
+        if (socket_path.empty()) {
+            channel.openStdio();
+        } else if (!channel.openSocket(socket_path, error)) {
+            std::cerr << "Ошибка сервера: " << error << "\n";
+            return 1;
+        }
+        double load_time_sec = std::chrono::duration<double>(steady_clock::now() - read_start).count();
+        std::fprintf(stderr, "Server ready: %d vertices, engine %s, load time %.6f s, cache %d trees, listening on %s\n",
+                     total_nodes, engine.c_str(), load_time_sec, cache_size, channel.description().c_str());
+
+        runQueryServer(channel, total_nodes, static_cast<std::size_t>(cache_size),
+                       [&](int source, int target, ShortestPathTree &tree, std::string &query_error) {
+            if (pair_engine && target < 0) {
+                query_error = "движок " + engine + " отвечает только на запросы \"S T\"";
+                return false;
+            }
+            tree.settled = run_engine(source, target);
+            if (engine == "alt") {
+                // Ответу нужны только цель и путь: копирование n элементов стоило бы дороже запроса
+                tree.dist.resize(total_nodes);
+                tree.pred.resize(total_nodes);
+                tree.dist[target] = dist[target] == INF ? -1 : dist[target];
+                tree.pred[target] = pred[target];
+                for (int v : alt_path) tree.pred[v] = pred[v];
+                return true;
+            }
+            tree.dist.resize(total_nodes);
+            tree.pred.assign(pred, pred + total_nodes);
+            for (int v = 0; v < total_nodes; ++v) {
+                bool unreachable = dist64.empty() ? dist[v] == INF : dist64[v] == distInfinity<std::int64_t>();
+                tree.dist[v] = unreachable ? -1 : (dist64.empty() ? dist[v] : dist64[v]);
+            }
+            return true;
+        });
+        return 0;
+    }
+
+    // Пакет изменений весов читается до расчёта, чтобы ошибка в файле не стоила полного прогона
+    std::vector<WeightUpdate> updates;
+    if (!updates_path.empty()) {
+        std::string error;
+        if (!readWeightUpdates(updates_path, total_nodes, updates, error)) {
+            std::cerr << "Ошибка чтения изменений: " << error << "\n";
+            return 1;
+        }
+    } else if (random_updates > 0) {
+        updates = randomWeightUpdates(csr_graph, random_updates, generator.min_weight, generator.max_weight, generator.seed);
+    }
+
+    steady_clock::time_point compute_start = steady_clock::now();
+    int settled = run_engine(start_vertex, target_vertex);
+    steady_clock::time_point compute_end = steady_clock::now();
     
     // ========================================================================================
     // Вывод
     // ========================================================================================
-    double compute_time_sec = double(compute_end - compute_start) / CLOCKS_PER_SEC;
-    double read_time_sec = double(compute_start - read_start) / CLOCKS_PER_SEC;
+    double compute_time_sec = std::chrono::duration<double>(compute_end - compute_start).count();
+    double read_time_sec = std::chrono::duration<double>(compute_start - read_start).count() - baseline_time_sec;
     std::printf("total_nodes: %d \n", total_nodes);
+    if (engine == "csr") {
+        std::printf("Engine: csr (%s queue), edges: %d\n", queue_kind.c_str(), csr_graph.numEdges());
+    } else if (engine == "delta") {
+        std::printf("Engine: delta-stepping, threads: %d, delta: %d, edges: %d\n", num_threads, delta, csr_graph.numEdges());
+    } else if (engine == "bidir") {
+        std::printf("Engine: bidirectional (%s queue), edges: %d\n", queue_kind.c_str(), csr_graph.numEdges());
+    } else if (engine == "alt") {
+        std::printf("Engine: alt (A* with %d landmarks, %d active per query), edges: %d\n", landmark_index.num_landmarks,
+                    alt_search->activeLandmarks(), csr_graph.numEdges());
+        std::printf("Landmarks: %s %s in %.6f s, index %.1f MB\n", build_landmarks ? "built into" : "loaded from", landmarks_path.c_str(),
+                    landmarks_time_sec, landmark_index.bytes() / 1e6);
+    } else {
+        const char *weight_name = dispatchWeightType(weight_bytes, [](auto tag) { return weightTypeName<decltype(tag)>(); });
+        std::size_t matrix_bytes = dispatchWeightType(weight_bytes, [&](auto tag) {
+            using W = decltype(tag);
+            std::size_t weights = packed ? PackedRowBlock<W>::blockSize(total_nodes, 0, total_nodes) : static_cast<std::size_t>(total_nodes) * total_nodes;
+            return weights * sizeof(W);
+        });
+        std::printf("Engine: dense (simd: %s, weights: %s, dist: %d-bit)\n", simdLevelName(dense_level), weight_name, dist_bits);
+        std::printf("Storage: %s, matrix: %.1f MB\n", storage.c_str(), matrix_bytes / 1e6);
+    }
+    if (!dense_storage.empty()) {
+        std::printf("Memory: matrix %s\n", dense_storage.report().describe().c_str());
+    } else if (graph_data) {
+        std::printf("Memory: matrix mapped from %s (page cache)\n", graph_path.c_str());
+    }
+    std::printf("Memory: dist/pred (each) %s\n", (dist64.empty() ? dist_storage.report() : dist64.report()).describe().c_str());
+    if (reorder != VertexOrder::None) {
+        std::printf("Reorder: %s, bandwidth %d -> %d, mean arc span %.1f -> %.1f, ordering time %.6f s\n", vertexOrderName(reorder),
+                    quality_before.bandwidth, quality_after.bandwidth, quality_before.mean_span, quality_after.mean_span, ordering_time_sec);
+    }
     std::printf("Compute time: %.6f seconds\n", compute_time_sec);
     std::printf("Matrix load time: %.6f s\n\n", read_time_sec);
+    if (profiling) printProfile(run_profile, compute_time_sec);
+    if (target_vertex >= 0) {
+        long long target_dist = dist64.empty() ? (dist[target_vertex] == INF ? -1 : dist[target_vertex])
+                              : (dist64[target_vertex] == distInfinity<std::int64_t>() ? -1 : dist64[target_vertex]);
+        printPathQuery(start_vertex, target_vertex, target_dist, settled, total_nodes, reconstructPath(pred, total_nodes, start_vertex, target_vertex));
+    }
+    if (reorder != VertexOrder::None) {
+        // Запрос с целью сверяет только её расстояние: остальные вершины могли остаться необработанными
+        bool match = target_vertex >= 0 ? dist[target_vertex] == baseline_dist[target_vertex]
+                                        : std::equal(baseline_dist.begin(), baseline_dist.end(), dist);
+        std::printf("Baseline (original order): %.6f s, speedup %.2fx, check: %s\n\n", baseline_time_sec,
+                    compute_time_sec > 0 ? baseline_time_sec / compute_time_sec : 0.0, match ? "OK" : "MISMATCH");
+        if (!match) {
+            return 1;
+        }
+    }
+    if (incremental) {
+        std::vector<AppliedUpdate> changes;
+        std::string error;
+        if (!applyWeightUpdates(csr_graph, symmetric ? nullptr : &reversed_graph, updates, changes, error)) {
+            std::cerr << "Ошибка применения изменений: " << error << "\n";
+            return 1;
+        }
+
+        steady_clock::time_point repair_start = steady_clock::now();
+        RepairStats repair = repairShortestPaths(csr_graph, backward_graph, changes, dist, pred);
+        double repair_time_sec = std::chrono::duration<double>(steady_clock::now() - repair_start).count();
+
+        // Контрольный полный пересчёт по изменённому графу
+        std::vector<int> check_dist(total_nodes), check_pred(total_nodes);
+        BinaryHeap check_queue;
+        steady_clock::time_point recompute_start = steady_clock::now();
+        int recompute_settled = dijkstra_csr(csr_graph, start_vertex, -1, check_dist.data(), check_pred.data(), check_queue);
+        double recompute_time_sec = std::chrono::duration<double>(steady_clock::now() - recompute_start).count();
+        bool match = std::equal(check_dist.begin(), check_dist.end(), dist);
+
+        std::printf("Updates: %zu (%zu arcs changed: %d increased, %d decreased)\n", updates.size(), changes.size(), repair.increased, repair.decreased);
+        std::printf("Repair: touched %d of %d vertices (%d invalidated), %llu arcs scanned, %.6f s\n",
+                    repair.touched, total_nodes, repair.invalidated, static_cast<unsigned long long>(repair.relaxations), repair_time_sec);
+        std::printf("Recompute: settled %d vertices, %.6f s, speedup %.1fx, check: %s\n\n", recompute_settled, recompute_time_sec,
+                    repair_time_sec > 0 ? recompute_time_sec / repair_time_sec : 0.0, match ? "OK" : "MISMATCH");
+        if (!match) {
+            return 1;
+        }
+    }
+
+    if (!output_path.empty()) {
+        steady_clock::time_point write_start = steady_clock::now();
+        bool written = dist64.empty() ? writeResultFile(output_path, total_nodes, start_vertex, target_vertex, dist, pred)
+                                      : writeResultFile(output_path, total_nodes, start_vertex, target_vertex, dist64.data(), pred);
+        if (!written) {
+            std::cerr << "Ошибка записи результата в " << output_path << "\n";
+            return 1;
+        }
+        std::printf("Result written to %s (%.1f MB) in %.6f s\n", output_path.c_str(),
+                    resultFileSize(makeResultHeader(total_nodes, start_vertex, target_vertex, dist64.empty() ? 4 : 8)) / 1e6,
+                    std::chrono::duration<double>(steady_clock::now() - write_start).count());
+    }
 
     // Для вывода матрицы смежности графа — раскомментировать:
     // std::cout << "Graph adjacency matrix:\n";
-    // for (int row = 0; row < total_nodes; ++row) {
-    //     for (int col = 0; col < total_nodes; ++col) {
-    //         if (graph_matrix[row * total_nodes + col] == INF)
-    //             std::cout << "INF ";
-    //         else
-    //             std::cout << graph_matrix[row * total_nodes + col] << " ";
+    // dispatchWeightType(weight_bytes, [&](auto tag) {
+    //     const auto *matrix = static_cast<const decltype(tag) *>(graph_data);
+    //     for (int row = 0; row < total_nodes; ++row) {
+    //         for (int col = 0; col < total_nodes; ++col) {
+    //             int w = decodeWeight(matrix[static_cast<std::size_t>(row) * total_nodes + col]);
+    //             if (w == INF)
+    //                 std::cout << "INF ";
+    //             else
+    //                 std::cout << w << " ";
+    //         }
+    //         std::cout << "\n";
     //     }
-    //     std::cout << "\n";
-    // }
+    // });
     // std::cout << "\n";
 
     // Для вывода путей — раскомментировать:
-    // std::cout << "The distance from the vertex is 0:\n";
+    // std::cout << "The distance from the vertex is " << start_vertex << ":\n";
     // for (int v = 0; v < total_nodes; ++v) {
-    //     if (dist[v] == INF)
+    //     bool unreachable = dist64.empty() ? dist[v] == INF : dist64[v] == distInfinity<std::int64_t>();
+    //     if (unreachable)
     //         std::cout << v << ": INF\n";
     //     else
-    //         std::cout << v << ": " << dist[v] << "\n";
+    //         std::cout << v << ": " << (dist64.empty() ? dist[v] : dist64[v]) << "\n";
     // }
 
-    std::free(dist);
-    std::free(pred);
-
     return 0;
 }
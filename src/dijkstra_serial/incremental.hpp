@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/graph_generator.hpp"
+#include "../common/priority_queue.hpp"
+#include "dijkstra_csr.hpp"
+
+/**
+ * @brief Новый вес дуги from -> to.
+ */
+struct WeightUpdate {
+    int from;
+    int to;
+    int weight;
+};
+
+/**
+ * @brief Применённое изменение дуги графа (для неориентированного графа — каждая из двух дуг).
+ */
+struct AppliedUpdate {
+    int from;
+    int to;
+    int old_weight;
+    int new_weight;
+};
+
+/**
+ * @brief Итоги восстановления дерева кратчайших путей.
+ */
+struct RepairStats {
+    int increased = 0;           // дуги с выросшим весом
+    int decreased = 0;           // дуги с уменьшившимся весом
+    int invalidated = 0;         // вершины поддеревьев под подорожавшими дугами дерева
+    int touched = 0;             // вершины, расстояние или предок которых пересчитывались
+    std::uint64_t relaxations = 0; // просмотренные дуги (входящие при переустановке и исходящие при распространении)
+};
+
+/**
+ * @brief Чтение пакета изменений весов из текстового файла: строки "u v w", '#' — комментарий.
+ * @return false, если файл не открылся или строка некорректна (описание в error).
+ */
+inline bool readWeightUpdates(const std::string &path, int countVertices, std::vector<WeightUpdate> &updates, std::string &error) {
+    std::ifstream input(path);
+    if (!input) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    updates.clear();
+    std::string line;
+    long long line_number = 0;
+    while (std::getline(input, line)) {
+        ++line_number;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        std::istringstream fields(line);
+        long long u = 0, v = 0, w = 0;
+        if (!(fields >> u >> v >> w) || u < 0 || v < 0 || u >= countVertices || v >= countVertices || w < 0 || w >= INF) {
+            error = "строка " + std::to_string(line_number) + ": ожидается \"u v w\" с вершинами из [0, " + std::to_string(countVertices) + ")";
+            return false;
+        }
+        updates.push_back({static_cast<int>(u), static_cast<int>(v), static_cast<int>(w)});
+    }
+    return true;
+}
+
+/**
+ * @brief Случайный пакет изменений существующих дуг: новый вес равномерен в [min_weight, max_weight].
+ *
+ * Дуги выбираются счётчиковым SplitMix64 от seed, так что пакет воспроизводим.
+ */
+inline std::vector<WeightUpdate> randomWeightUpdates(const CsrGraph &graph, int count, int min_weight, int max_weight, std::uint64_t seed) {
+    std::vector<WeightUpdate> updates;
+    const std::uint64_t num_edges = static_cast<std::uint64_t>(graph.numEdges());
+    if (num_edges == 0) return updates;
+
+    const std::uint64_t range = static_cast<std::uint64_t>(max_weight) - min_weight + 1;
+    for (int k = 0; k < count; ++k) {
+        std::uint64_t h = splitMix64(splitMix64(seed ^ 0x5EEDULL) + static_cast<std::uint64_t>(k));
+        std::uint64_t e = ((h >> 32) * num_edges) >> 32;
+        int weight = min_weight + static_cast<int>(((splitMix64(h) >> 32) * range) >> 32);
+
+        // Источник дуги e — последняя строка, начинающаяся не позже e
+        int lo = 0, hi = graph.num_vertices - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (static_cast<std::uint64_t>(graph.row_offsets[mid]) <= e) lo = mid; else hi = mid - 1;
+        }
+        updates.push_back({lo, graph.col_indices[e], weight});
+    }
+    return updates;
+}
+
+namespace incremental_detail {
+
+// Установить вес всех дуг from -> to; false, если таких дуг нет.
+// old_weight — действующий вес до изменения: минимум по параллельным дугам
+inline bool setArcWeight(CsrGraph &graph, int from, int to, int weight, int &old_weight) {
+    bool found = false;
+    for (int e = graph.row_offsets[from]; e < graph.row_offsets[from + 1]; ++e) {
+        if (graph.col_indices[e] != to) continue;
+        if (!found || graph.weights[e] < old_weight) old_weight = graph.weights[e];
+        graph.weights[e] = weight;
+        found = true;
+    }
+    return found;
+}
+
+// Повторное изменение дуги в пакете сохраняет исходный старый вес и последний новый
+inline void recordChange(std::vector<AppliedUpdate> &applied, std::unordered_map<std::uint64_t, std::size_t> &index,
+                         int from, int to, int old_weight, int new_weight) {
+    std::uint64_t key = (static_cast<std::uint64_t>(from) << 32) | static_cast<std::uint32_t>(to);
+    auto inserted = index.emplace(key, applied.size());
+    if (inserted.second) {
+        applied.push_back({from, to, old_weight, new_weight});
+    } else {
+        applied[inserted.first->second].new_weight = new_weight;
+    }
+}
+
+} // namespace incremental_detail
+
+/**
+ * @brief Применение пакета изменений весов к CSR-графу (и его транспонированной копии).
+ *
+ * Для неориентированного графа изменение (u, v) применяется к обеим дугам. Добавление
+ * и удаление рёбер не поддерживаются: меняются только веса существующих дуг.
+ * @param reversed Транспонированный граф для ориентированного случая (nullptr — граф симметричен).
+ * @param applied [out] Изменённые дуги: вес до пакета и после него (повторы дуги объединены,
+ *                     дуги с прежним итоговым весом отброшены).
+ * @return false, если одной из дуг нет в графе (описание в error; граф частично изменён).
+ */
+inline bool applyWeightUpdates(CsrGraph &graph, CsrGraph *reversed, const std::vector<WeightUpdate> &updates,
+                               std::vector<AppliedUpdate> &applied, std::string &error) {
+    using namespace incremental_detail;
+
+    applied.clear();
+    std::unordered_map<std::uint64_t, std::size_t> index; // дуга -> её запись в applied
+    for (const WeightUpdate &update : updates) {
+        int old_weight = 0, reverse_old_weight = 0;
+        if (!setArcWeight(graph, update.from, update.to, update.weight, old_weight)) {
+            error = "нет дуги " + std::to_string(update.from) + " -> " + std::to_string(update.to);
+            return false;
+        }
+        if (reversed) {
+            setArcWeight(*reversed, update.to, update.from, update.weight, reverse_old_weight);
+        } else if (update.from != update.to) {
+            setArcWeight(graph, update.to, update.from, update.weight, reverse_old_weight);
+        }
+
+        // Все параллельные дуги получают новый вес, так что действующий вес меняется с минимума на update.weight
+        recordChange(applied, index, update.from, update.to, old_weight, update.weight);
+        if (!reversed && update.from != update.to) recordChange(applied, index, update.to, update.from, reverse_old_weight, update.weight);
+    }
+
+    // Дуги, вес которых в итоге не изменился, восстановлению не нужны
+    applied.erase(std::remove_if(applied.begin(), applied.end(),
+                                 [](const AppliedUpdate &change) { return change.old_weight == change.new_weight; }),
+                  applied.end());
+    return true;
+}
+
+/**
+ * @brief Восстановление dist/pred после изменения весов без полного перезапуска (в духе Ramalingam — Reps).
+ *
+ * 1. Подорожавшие дуги дерева (pred[to] == from): поддерево под to помечается недействительным,
+ *    каждой его вершине заново выбирается лучший предок среди входящих дуг из не затронутых вершин.
+ * 2. Подешевевшие дуги: конец дуги получает новое расстояние, если путь через дугу короче.
+ * 3. Вершины, получившие новое расстояние на шагах 1–2, становятся источниками одного прохода
+ *    Дейкстры: он распространяет уменьшения и доводит переустановленные вершины до точных значений.
+ * Работа пропорциональна затронутой части графа, а не всему графу.
+ *
+ * @param graph CSR-граф с уже изменёнными весами (applyWeightUpdates).
+ * @param reversed Транспонированный граф с теми же весами (для неориентированного — сам graph).
+ * @param changes Изменённые дуги (applyWeightUpdates).
+ * @param dist [in/out] Кратчайшие расстояния до изменений; на выходе — для нового графа.
+ * @param pred [in/out] Предшественники.
+ */
+inline RepairStats repairShortestPaths(const CsrGraph &graph, const CsrGraph &reversed,
+                                       const std::vector<AppliedUpdate> &changes, int *dist, int *pred) {
+    const int n = graph.num_vertices;
+    RepairStats stats;
+    std::vector<char> affected(n, 0);
+    std::vector<int> invalid;   // поддеревья под подорожавшими дугами дерева
+    BinaryHeap queue;
+
+    // 1. Сбор поддеревьев: дети вершины x — концы её дуг, у которых pred == x
+    for (const AppliedUpdate &change : changes) {
+        if (change.new_weight > change.old_weight) {
+            ++stats.increased;
+            if (pred[change.to] != change.from || affected[change.to]) continue;
+            affected[change.to] = 1;
+            invalid.push_back(change.to);
+        } else {
+            ++stats.decreased;
+        }
+    }
+    for (std::size_t k = 0; k < invalid.size(); ++k) {
+        int x = invalid[k];
+        for (int e = graph.row_offsets[x]; e < graph.row_offsets[x + 1]; ++e) {
+            int y = graph.col_indices[e];
+            ++stats.relaxations;
+            if (pred[y] == x && !affected[y]) {
+                affected[y] = 1;
+                invalid.push_back(y);
+            }
+        }
+    }
+    stats.invalidated = static_cast<int>(invalid.size());
+    for (int x : invalid) {
+        dist[x] = INF;
+        pred[x] = -1;
+    }
+
+    // Лучший предок среди входящих дуг из вершин с действительным расстоянием
+    for (int x : invalid) {
+        for (int e = reversed.row_offsets[x]; e < reversed.row_offsets[x + 1]; ++e) {
+            int u = reversed.col_indices[e];
+            int w = reversed.weights[e];
+            ++stats.relaxations;
+            if (affected[u] || dist[u] > INF - w || dist[u] + w >= dist[x]) continue;
+            dist[x] = dist[u] + w;
+            pred[x] = u;
+        }
+        if (dist[x] != INF) queue.push({dist[x], x});
+    }
+
+    // 2. Подешевевшие дуги
+    for (const AppliedUpdate &change : changes) {
+        if (change.new_weight >= change.old_weight) continue;
+        int u = change.from, v = change.to;
+        if (affected[u] || dist[u] > INF - change.new_weight || dist[u] + change.new_weight >= dist[v]) continue;
+        dist[v] = dist[u] + change.new_weight;
+        pred[v] = u;
+        queue.push({dist[v], v});
+    }
+
+    // 3. Распространение от всех изменённых вершин
+    std::vector<char> touched(n, 0);
+    for (int x : invalid) touched[x] = 1;
+    stats.touched = stats.invalidated;
+    while (!queue.empty()) {
+        QueueItem item = queue.pop();
+        int u = item.vertex;
+        if (item.dist > dist[u]) continue;
+        if (!touched[u]) {
+            touched[u] = 1;
+            ++stats.touched;
+        }
+
+        for (int e = graph.row_offsets[u]; e < graph.row_offsets[u + 1]; ++e) {
+            int v = graph.col_indices[e];
+            int w = graph.weights[e];
+            ++stats.relaxations;
+            if (dist[u] > INF - w || dist[u] + w >= dist[v]) continue;
+            dist[v] = dist[u] + w;
+            pred[v] = u;
+            queue.push({dist[v], v});
+        }
+    }
+    return stats;
+}
+
+/**
+ * @brief Самопроверка восстановления: repairShortestPaths против полного пересчёта dijkstra_csr.
+ *
+ * Случайные ориентированные и неориентированные графы с параллельными дугами и петлями;
+ * пакеты изменений — случайные дуги и параллельные пары, получающие вес между своим
+ * минимумом и максимумом (действующий вес такой пары растёт, хотя первая дуга дешевеет).
+ * @return true, если все восстановленные dist совпали с пересчётом.
+ */
+inline bool incrementalSelfTest() {
+    std::mt19937 rng(2024);
+    int failures = 0, cases = 0;
+
+    for (int trial = 0; trial < 200; ++trial) {
+        const bool symmetric = trial % 2 == 1;
+        const int n = 2 + static_cast<int>(rng() % 60);
+        const int m = n * (1 + static_cast<int>(rng() % 4));
+        std::vector<Edge> edges;
+        std::vector<WeightUpdate> parallel_updates;
+        for (int k = 0; k < m; ++k) {
+            int u = static_cast<int>(rng() % n), v = static_cast<int>(rng() % n);
+            int w = 1 + static_cast<int>(rng() % 20);
+            edges.push_back({u, v, w});
+            if (symmetric && u != v) edges.push_back({v, u, w});
+            if (rng() % 4 == 0) {
+                int w2 = 1 + static_cast<int>(rng() % 20);
+                edges.push_back({u, v, w2});
+                if (symmetric && u != v) edges.push_back({v, u, w2});
+                parallel_updates.push_back({u, v, (std::min(w, w2) + std::max(w, w2)) / 2});
+            }
+        }
+        std::shuffle(edges.begin(), edges.end(), rng);
+        CsrGraph graph = buildCsrFromEdges(n, edges);
+        CsrGraph reversed = symmetric ? CsrGraph{} : transposeCsr(graph);
+
+        std::vector<WeightUpdate> updates = parallel_updates;
+        for (int k = 0; k < 1 + static_cast<int>(rng() % 5); ++k) {
+            const Edge &e = edges[rng() % edges.size()];
+            updates.push_back({e.from, e.to, 1 + static_cast<int>(rng() % 20)});
+        }
+
+        const int source = static_cast<int>(rng() % n);
+        std::vector<int> dist(n), pred(n), check_dist(n), check_pred(n);
+        BinaryHeap queue;
+        dijkstra_csr(graph, source, -1, dist.data(), pred.data(), queue);
+
+        std::vector<AppliedUpdate> changes;
+        std::string error;
+        ++cases;
+        if (!applyWeightUpdates(graph, symmetric ? nullptr : &reversed, updates, changes, error)) {
+            ++failures;
+            continue;
+        }
+        repairShortestPaths(graph, symmetric ? graph : reversed, changes, dist.data(), pred.data());
+        BinaryHeap check_queue;
+        dijkstra_csr(graph, source, -1, check_dist.data(), check_pred.data(), check_queue);
+        if (dist != check_dist) ++failures;
+    }
+
+    std::printf("Incremental self-test : %s (%d cases, %d failures)\n", failures == 0 ? "OK" : "FAIL", cases, failures);
+    return failures == 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../common/cli.hpp"
+#include "../common/graph.hpp"
+#include "../common/graph_file.hpp"
+
+/**
+ * @brief Конвертер текстового списка рёбер в бинарный формат графа (common/graph_file.hpp).
+ *
+ * Формат входа: по ребру в строке "u v [w]" (вершины с нуля, вес по умолчанию 1),
+ * пустые строки и строки, начинающиеся с '#' или '%', пропускаются.
+ *
+ * Параметры: <edges.txt> <graph.bin> [--layout=dense|csr] [--weight-bytes=auto|1|2|4]
+ *            [--undirected] [--vertices=N]
+ */
+int main(int argc, char *argv[]) {
+    std::string input_path, output_path;
+    std::string layout = "csr";
+    std::string weight_bytes_spec = "auto";
+    bool undirected = false;
+    long long vertices_override = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseOption(argv[i], "--layout", value)) {
+            layout = value;
+        } else if (parseOption(argv[i], "--weight-bytes", value)) {
+            weight_bytes_spec = value;
+        } else if (parseOption(argv[i], "--vertices", value)) {
+            vertices_override = std::stoll(value);
+        } else if (parseFlag(argv[i], "--undirected")) {
+            undirected = true;
+        } else if (input_path.empty()) {
+            input_path = argv[i];
+        } else if (output_path.empty()) {
+            output_path = argv[i];
+        } else {
+            std::cerr << "Лишний параметр: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    if (input_path.empty() || output_path.empty() || (layout != "dense" && layout != "csr")) {
+        std::cerr << "Использование: graph_convert <edges.txt> <graph.bin> [--layout=dense|csr] "
+                     "[--weight-bytes=auto|1|2|4] [--undirected] [--vertices=N]\n";
+        return 1;
+    }
+
+    std::ifstream input(input_path);
+    if (!input) {
+        std::cerr << "Не удалось открыть " << input_path << "\n";
+        return 1;
+    }
+
+    // Чтение рёбер
+    std::vector<Edge> edges;
+    long long max_vertex = -1;
+    int max_weight = 0;
+    std::string line;
+    long long line_number = 0;
+    while (std::getline(input, line)) {
+        ++line_number;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#' || line[first] == '%') continue;
+
+        std::istringstream fields(line);
+        long long u = 0, v = 0, w = 1;
+        if (!(fields >> u >> v)) {
+            std::cerr << "Строка " << line_number << ": ожидается \"u v [w]\"\n";
+            return 1;
+        }
+        fields >> w;
+        if (u < 0 || v < 0 || u >= INF || v >= INF || w < 0 || w >= INF) {
+            std::cerr << "Строка " << line_number << ": вершина или вес вне допустимого диапазона\n";
+            return 1;
+        }
+
+        edges.push_back({static_cast<int>(u), static_cast<int>(v), static_cast<int>(w)});
+        if (undirected && u != v) edges.push_back({static_cast<int>(v), static_cast<int>(u), static_cast<int>(w)});
+        if (u > max_vertex) max_vertex = u;
+        if (v > max_vertex) max_vertex = v;
+        if (w > max_weight) max_weight = static_cast<int>(w);
+    }
+
+    long long num_vertices = vertices_override >= 0 ? vertices_override : max_vertex + 1;
+    if (num_vertices <= max_vertex) {
+        std::cerr << "--vertices меньше максимального номера вершины + 1\n";
+        return 1;
+    }
+
+    std::uint32_t weight_bytes = weightBytesFor(max_weight);
+    if (weight_bytes_spec != "auto") {
+        weight_bytes = static_cast<std::uint32_t>(std::stoi(weight_bytes_spec));
+        if (weight_bytes != 1 && weight_bytes != 2 && weight_bytes != 4) {
+            std::cerr << "--weight-bytes должен быть 1, 2, 4 или auto\n";
+            return 1;
+        }
+        if (weightBytesFor(max_weight) > weight_bytes) {
+            std::cerr << "Максимальный вес " << max_weight << " не помещается в " << weight_bytes << " байт\n";
+            return 1;
+        }
+    }
+
+    // Запись
+    const int n = static_cast<int>(num_vertices);
+    bool ok;
+    if (layout == "dense") {
+        std::vector<int> flat(static_cast<std::size_t>(n) * n, INF);
+        for (int v = 0; v < n; ++v) flat[static_cast<std::size_t>(v) * n + v] = 0;
+        for (const Edge &e : edges) {
+            int &cell = flat[static_cast<std::size_t>(e.from) * n + e.to];
+            if (e.from != e.to && e.weight < cell) cell = e.weight; // из кратных рёбер оставляем лёгкое
+        }
+        ok = writeDenseGraphFile(output_path, flat.data(), n, weight_bytes, undirected);
+    } else {
+        CsrGraph graph = buildCsrFromEdges(n, edges);
+        ok = writeCsrGraphFile(output_path, graph, weight_bytes, undirected);
+    }
+
+    if (!ok) {
+        std::cerr << "Ошибка записи " << output_path << "\n";
+        return 1;
+    }
+
+    std::printf("Записан граф: %d вершин, %zu рёбер, раскладка %s, вес %u байт -> %s\n",
+                n, edges.size(), layout.c_str(), weight_bytes, output_path.c_str());
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "../common/path.hpp"
+#include "../common/result_file.hpp"
+
+/**
+ * @brief Восстановление путей по бинарному файлу результата (common/result_file.hpp).
+ *
+ * Файл пишут dijkstra_serial и dijkstra_mpi с параметром --output=file. Он отображается
+ * в память, и для каждой цели читаются только её расстояние и цепочка предков, поэтому
+ * запрос к дереву на миллионы вершин не требует загрузки массивов целиком.
+ *
+ * Параметры: <result.bin> [T1 T2 ...] — без целей печатается сводка по файлу
+ *            (источник, число вершин, достижимые вершины, наибольшее расстояние).
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Использование: path_query <result.bin> [T1 T2 ...]\n";
+        return 1;
+    }
+
+    MappedResultFile result;
+    std::string error;
+    if (!result.open(argv[1], error)) {
+        std::cerr << "Ошибка чтения результата: " << error << "\n";
+        return 1;
+    }
+
+    const int n = result.numVertices();
+    const int source = result.source();
+    const long long saved_target = result.header().target;
+    std::vector<int> targets;
+    for (int i = 2; i < argc; ++i) {
+        int target = -1;
+        try {
+            target = std::stoi(argv[i]);
+        } catch (const std::exception &) {
+        }
+        if (target < 0 || target >= n) {
+            std::cerr << "Некорректная вершина: " << argv[i] << " (вершин в файле: " << n << ")\n";
+            return 1;
+        }
+        targets.push_back(target);
+    }
+
+    // Расчёт с --target останавливается на цели: расстояния остальных вершин не окончательные
+    if (saved_target >= 0) {
+        std::fprintf(stderr, "Предупреждение: файл получен запросом %d -> %lld, точен только путь до %lld\n",
+                     source, saved_target, saved_target);
+    }
+
+    if (targets.empty()) {
+        int reachable = 0;
+        long long max_distance = 0;
+        for (int v = 0; v < n; ++v) {
+            long long d = result.distance(v);
+            if (d < 0) continue;
+            ++reachable;
+            if (d > max_distance) max_distance = d;
+        }
+        std::printf("Result: source %d, %d vertices, %d reachable, max distance %lld, distances %u-byte%s\n", source, n, reachable,
+                    max_distance, result.header().dist_bytes, saved_target >= 0 ? ", partial (--target)" : "");
+        return 0;
+    }
+
+    for (int target : targets) {
+        long long distance = result.distance(target);
+        std::vector<int> path = distance < 0 ? std::vector<int>{} : reconstructPath(result.pred(), n, source, target);
+        if (path.empty()) {
+            std::printf("Query: %d -> %d, unreachable\n", source, target);
+        } else {
+            std::printf("Query: %d -> %d, distance: %lld\n", source, target, distance);
+        }
+        printPathLine(path);
+    }
+    return 0;
+}